@@ -46,14 +46,35 @@
 #include <cstring>
 #include <climits>
 #include <cmath>
+#include <ctime>
+#include <cerrno>
 #include <algorithm>
 
-// Static variable definitions.
-const unsigned int RtApi::MAX_SAMPLE_RATES = 14;
-const unsigned int RtApi::SAMPLE_RATES[] = {
-  4000, 5512, 8000, 9600, 11025, 16000, 22050,
-  32000, 44100, 48000, 88200, 96000, 176400, 192000
-};
+#if defined(__linux__)
+  #include <unistd.h>
+  #include <dirent.h>
+  #include <sys/syscall.h>
+  #include <linux/futex.h>
+#endif
+
+#if defined(__RTAUDIO_PLUGINS__)
+  #include <dlfcn.h>
+#endif
+
+// A plugin (see createPluginApi()) is built from this file with the
+// code of its own API only, and uses the common code of the library.
+#if defined(__RTAUDIO_PLUGIN_JACK__) || defined(__RTAUDIO_PLUGIN_ALSA__) || defined(__RTAUDIO_PLUGIN_PULSE__)
+  #define __RTAUDIO_PLUGIN_ONLY__
+#endif
+
+#if defined(_WIN32)
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <sched.h>
+#endif
 
 #if defined(__WINDOWS_DS__) || defined(__WINDOWS_ASIO__) || defined(__WINDOWS_WASAPI__)
   #define MUTEX_INITIALIZE(A) InitializeCriticalSection(A)
@@ -83,9 +104,105 @@ const unsigned int RtApi::SAMPLE_RATES[] = {
   #define MUTEX_LOCK(A)       pthread_mutex_lock(A)
   #define MUTEX_UNLOCK(A)     pthread_mutex_unlock(A)
 #else
-  #define MUTEX_INITIALIZE(A) abs(*A) // dummy definitions
-  #define MUTEX_DESTROY(A)    abs(*A) // dummy definitions
+  #define MUTEX_INITIALIZE(A) ((void)(A)) // dummy definitions
+  #define MUTEX_DESTROY(A)    ((void)(A)) // dummy definitions
+  #define MUTEX_LOCK(A)       ((void)(A)) // dummy definitions
+  #define MUTEX_UNLOCK(A)     ((void)(A)) // dummy definitions
+#endif
+
+// *************************************************** //
+//
+// Helpers shared by the common code and the APIs.
+//
+// *************************************************** //
+
+#if !defined(__RTAUDIO_PLUGIN_ONLY__) || defined(__RTAUDIO_PLUGIN_ALSA__)
+// Returns the current time in seconds on a monotonic clock, or zero
+// if no such clock is available.
+static double getMonotonicTime( void )
+{
+#if defined(CLOCK_MONOTONIC)
+  struct timespec now;
+  clock_gettime( CLOCK_MONOTONIC, &now );
+  return now.tv_sec + now.tv_nsec * 1e-9;
+#else
+  return 0.0;
+#endif
+}
+#endif
+
+#if ( defined(__LINUX_ALSA__) && ( !defined(__RTAUDIO_PLUGINS__) || defined(__RTAUDIO_PLUGIN_ALSA__) ) ) || \
+    ( defined(__LINUX_PULSE__) && ( !defined(__RTAUDIO_PLUGINS__) || defined(__RTAUDIO_PLUGIN_PULSE__) ) ) || \
+    ( defined(__LINUX_OSS__) && !defined(__RTAUDIO_PLUGIN_ONLY__) )
+// Returns the latency target of the stream options in sample frames,
+// or zero when the buffer size and number of buffers are used instead.
+static unsigned int getTargetLatencyFrames( RtAudio::StreamOptions *options, unsigned int sampleRate )
+{
+  if ( options == NULL || options->targetLatency == 0 ) return 0;
+  unsigned int frames = (unsigned int) ( (double) options->targetLatency * sampleRate / 1000000.0 );
+  return frames > 0 ? frames : 1;
+}
+#endif
+
+// Lets the client wait for the callback thread without a lock.  The
+// callback thread bumps a sequence number, and only makes a system
+// call when a client is waiting.  Without futexes, the client polls.
+class StreamWaiter {
+ public:
+  StreamWaiter()
+    :sequence_(0), waiters_(0) {}
+
+  int sequence( void ) const { return sequence_; }
+
+  void wake( void )
+  {
+#if defined(__GNUC__)
+    __sync_fetch_and_add( &sequence_, 1 );
+#else
+    sequence_++;
+#endif
+#if defined(__linux__) && defined(SYS_futex)
+    RTAUDIO_MEMORY_BARRIER();
+    if ( waiters_ > 0 )
+      syscall( SYS_futex, &sequence_, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0 );
+#endif
+  }
+
+  // Waits until wake() is called after sequence() returned 'value'.
+  void wait( int value, double timeout )
+  {
+#if defined(__linux__) && defined(SYS_futex)
+    struct timespec time;
+    time.tv_sec = (time_t) timeout;
+    time.tv_nsec = (long) ( ( timeout - time.tv_sec ) * 1e9 );
+    __sync_fetch_and_add( &waiters_, 1 );
+    syscall( SYS_futex, &sequence_, FUTEX_WAIT_PRIVATE, value, &time, NULL, 0 );
+    __sync_fetch_and_sub( &waiters_, 1 );
+#else
+    (void) timeout;
+    if ( sequence_ != value ) return;
+  #if defined(_WIN32)
+    Sleep( 1 );
+  #else
+    struct timespec time = { 0, 1000000 };
+    nanosleep( &time, NULL );
+  #endif
 #endif
+  }
+
+ private:
+  volatile int sequence_;
+  volatile int waiters_;
+};
+
+#if !defined(__RTAUDIO_PLUGIN_ONLY__)
+
+// Static variable definitions.
+const unsigned int RtApi::MAX_SAMPLE_RATES = 14;
+const unsigned int RtApi::SAMPLE_RATES[] = {
+  4000, 5512, 8000, 9600, 11025, 16000, 22050,
+  32000, 44100, 48000, 88200, 96000, 176400, 192000
+};
 
 // *************************************************** //
 //
@@ -133,48 +250,196 @@ void RtAudio :: getCompiledApi( std::vector<RtAudio::Api> &apis )
 #endif
 }
 
-void RtAudio :: openRtApi( RtAudio::Api api )
-{
-  if ( rtapi_ )
-    delete rtapi_;
-  rtapi_ = 0;
+#if defined(__RTAUDIO_PLUGINS__)
+// With __RTAUDIO_PLUGINS__, the JACK, ALSA and PulseAudio APIs are
+// built as plugins, librtaudio_<name>.so, such that their libraries
+// are only loaded by a process that uses them.  A plugin is loaded
+// from the RTAUDIO_PLUGIN_PATH directory, or else RTAUDIO_PLUGIN_DIR
+// or the library search path, when its API is first opened, and
+// stays loaded.  It exports rtaudio_create_api(), which creates an
+// instance of its API.  A plugin that is missing or lacks the
+// function leaves its API unavailable.
+static RtApi *createPluginApi( const char *name )
+{
+  std::string file = std::string( "librtaudio_" ) + name + ".so";
+  const char *directory = getenv( "RTAUDIO_PLUGIN_PATH" );
+#if defined(RTAUDIO_PLUGIN_DIR)
+  if ( directory == NULL ) directory = RTAUDIO_PLUGIN_DIR;
+#endif
+
+  void *plugin = NULL;
+  if ( directory && *directory )
+    plugin = dlopen( ( std::string( directory ) + "/" + file ).c_str(), RTLD_LAZY | RTLD_LOCAL );
+  if ( plugin == NULL )
+    plugin = dlopen( file.c_str(), RTLD_LAZY | RTLD_LOCAL );
+  if ( plugin == NULL ) return 0;
+
+  typedef RtApi *(*CreateApi)( void );
+  CreateApi create = (CreateApi) dlsym( plugin, "rtaudio_create_api" );
+  if ( create == NULL ) {
+    dlclose( plugin );
+    return 0;
+  }
+  return create();
+}
+
+  #define NEW_PLUGIN_API( Class, name ) createPluginApi( name )
+#else
+  #define NEW_PLUGIN_API( Class, name ) new Class()
+#endif
 
+// Creates an instance of the specified API, or returns zero if there
+// is no compiled support for it.
+static RtApi *createRtApi( RtAudio::Api api )
+{
 #if defined(__UNIX_JACK__)
-  if ( api == UNIX_JACK )
-    rtapi_ = new RtApiJack();
+  if ( api == RtAudio::UNIX_JACK )
+    return NEW_PLUGIN_API( RtApiJack, "jack" );
 #endif
 #if defined(__LINUX_ALSA__)
-  if ( api == LINUX_ALSA )
-    rtapi_ = new RtApiAlsa();
+  if ( api == RtAudio::LINUX_ALSA )
+    return NEW_PLUGIN_API( RtApiAlsa, "alsa" );
 #endif
 #if defined(__LINUX_PULSE__)
-  if ( api == LINUX_PULSE )
-    rtapi_ = new RtApiPulse();
+  if ( api == RtAudio::LINUX_PULSE )
+    return NEW_PLUGIN_API( RtApiPulse, "pulse" );
 #endif
 #if defined(__LINUX_OSS__)
-  if ( api == LINUX_OSS )
-    rtapi_ = new RtApiOss();
+  if ( api == RtAudio::LINUX_OSS )
+    return new RtApiOss();
 #endif
 #if defined(__WINDOWS_ASIO__)
-  if ( api == WINDOWS_ASIO )
-    rtapi_ = new RtApiAsio();
+  if ( api == RtAudio::WINDOWS_ASIO )
+    return new RtApiAsio();
 #endif
 #if defined(__WINDOWS_WASAPI__)
-  if ( api == WINDOWS_WASAPI )
-    rtapi_ = new RtApiWasapi();
+  if ( api == RtAudio::WINDOWS_WASAPI )
+    return new RtApiWasapi();
 #endif
 #if defined(__WINDOWS_DS__)
-  if ( api == WINDOWS_DS )
-    rtapi_ = new RtApiDs();
+  if ( api == RtAudio::WINDOWS_DS )
+    return new RtApiDs();
 #endif
 #if defined(__MACOSX_CORE__)
-  if ( api == MACOSX_CORE )
-    rtapi_ = new RtApiCore();
+  if ( api == RtAudio::MACOSX_CORE )
+    return new RtApiCore();
 #endif
 #if defined(__RTAUDIO_DUMMY__)
-  if ( api == RTAUDIO_DUMMY )
-    rtapi_ = new RtApiDummy();
+  if ( api == RtAudio::RTAUDIO_DUMMY )
+    return new RtApiDummy();
+#endif
+  return 0;
+}
+
+// The short names of the APIs, for getCompiledApiByName().
+static const struct {
+  const char *name;
+  RtAudio::Api api;
+} API_NAMES[] = {
+  { "jack", RtAudio::UNIX_JACK },
+  { "alsa", RtAudio::LINUX_ALSA },
+  { "pulse", RtAudio::LINUX_PULSE },
+  { "oss", RtAudio::LINUX_OSS },
+  { "asio", RtAudio::WINDOWS_ASIO },
+  { "wasapi", RtAudio::WINDOWS_WASAPI },
+  { "ds", RtAudio::WINDOWS_DS },
+  { "core", RtAudio::MACOSX_CORE },
+  { "dummy", RtAudio::RTAUDIO_DUMMY }
+};
+
+RtAudio::Api RtAudio :: getCompiledApiByName( const std::string &name )
+{
+  std::vector<RtAudio::Api> apis;
+  getCompiledApi( apis );
+  for ( unsigned int i=0; i<sizeof( API_NAMES ) / sizeof( API_NAMES[0] ); i++ ) {
+    if ( name != API_NAMES[i].name ) continue;
+    if ( std::find( apis.begin(), apis.end(), API_NAMES[i].api ) != apis.end() )
+      return API_NAMES[i].api;
+  }
+  return UNSPECIFIED;
+}
+
+// Cheap checks of the presence of an API, which spare the
+// constructor opening the API and enumerating its devices to select
+// it.  An API without such a check is UNKNOWN.
+enum ApiPresence { API_ABSENT, API_PRESENT, API_UNKNOWN };
+
+#if defined(__LINUX_ALSA__)
+// A card has a control device node, which is what snd_card_next()
+// looks for, without loading the ALSA library.
+static bool isAlsaCardPresent( void )
+{
+  DIR *dir = opendir( "/dev/snd" );
+  if ( dir == NULL ) return false;
+  bool isPresent = false;
+  struct dirent *entry;
+  while ( !isPresent && ( entry = readdir( dir ) ) != NULL )
+    isPresent = ( strncmp( entry->d_name, "controlC", 8 ) == 0 );
+  closedir( dir );
+  return isPresent;
+}
+#endif
+
+#if ( defined(__UNIX_JACK__) && defined(__linux__) ) || defined(__LINUX_PULSE__)
+static bool isUserSocket( const std::string &path )
+{
+  return access( path.c_str(), F_OK ) == 0;
+}
+#endif
+
+static ApiPresence getApiPresence( RtAudio::Api api )
+{
+#if ( defined(__UNIX_JACK__) && defined(__linux__) ) || defined(__LINUX_PULSE__)
+  const char *runtime = getenv( "XDG_RUNTIME_DIR" );
+  std::ostringstream runtimeDir;
+  if ( runtime ) runtimeDir << runtime;
+  else runtimeDir << "/run/user/" << getuid();
+#endif
+#if defined(__UNIX_JACK__) && defined(__linux__)
+  if ( api == RtAudio::UNIX_JACK ) {
+    // A server has a socket named after the server and the user:
+    // jack_<server>_<uid>_0 for Jack 2 and jack-<uid>/<server>/jack_0
+    // for Jack 1.  The Jack library of PipeWire uses the PipeWire
+    // socket instead, which is only a hint.
+    const char *server = getenv( "JACK_DEFAULT_SERVER" );
+    if ( server == NULL ) server = "default";
+    std::ostringstream jack2, jack1, jack1Tmp;
+    jack2 << "/dev/shm/jack_" << server << "_" << getuid() << "_0";
+    jack1 << "/dev/shm/jack-" << getuid() << "/" << server << "/jack_0";
+    jack1Tmp << "/tmp/jack-" << getuid() << "/" << server << "/jack_0";
+    if ( isUserSocket( jack2.str() ) || isUserSocket( jack1.str() ) || isUserSocket( jack1Tmp.str() ) )
+      return API_PRESENT;
+    if ( isUserSocket( runtimeDir.str() + "/pipewire-0" ) ) return API_UNKNOWN;
+    return API_ABSENT;
+  }
+#endif
+#if defined(__LINUX_ALSA__)
+  if ( api == RtAudio::LINUX_ALSA )
+    return isAlsaCardPresent() ? API_PRESENT : API_ABSENT;
+#endif
+#if defined(__LINUX_PULSE__)
+  if ( api == RtAudio::LINUX_PULSE ) {
+    if ( getenv( "PULSE_SERVER" ) ) return API_UNKNOWN;
+    if ( isUserSocket( runtimeDir.str() + "/pulse/native" ) || isUserSocket( "/var/run/pulse/native" ) )
+      return API_PRESENT;
+    return API_ABSENT;
+  }
+#endif
+#if defined(__LINUX_OSS__)
+  if ( api == RtAudio::LINUX_OSS )
+    return access( "/dev/mixer", F_OK ) == 0 ? API_PRESENT : API_ABSENT;
 #endif
+  (void) api;
+  return API_UNKNOWN;
+}
+
+void RtAudio :: openRtApi( RtAudio::Api api )
+{
+  if ( rtapi_ )
+    delete rtapi_;
+  rtapi_ = 0;
+
+  rtapi_ = createRtApi( api );
 }
 
 RtAudio :: RtAudio( RtAudio::Api api )
@@ -191,15 +456,29 @@ RtAudio :: RtAudio( RtAudio::Api api )
     std::cerr << "\nRtAudio: no compiled support for specified API argument!\n" << std::endl;
   }
 
+  // The environment can name the API to use.
+  const char *name = getenv( "RTAUDIO_API" );
+  if ( name && *name ) {
+    openRtApi( getCompiledApiByName( name ) );
+    if ( rtapi_ ) return;
+    std::cerr << "\nRtAudio: no compiled support for the API named by RTAUDIO_API (" << name << ")!\n" << std::endl;
+  }
+
   // Iterate through the compiled APIs and return as soon as we find
-  // one with at least one device or we reach the end of the list.
+  // one that is present or has at least one device, or we reach the
+  // end of the list.
   std::vector< RtAudio::Api > apis;
   getCompiledApi( apis );
   for ( unsigned int i=0; i<apis.size(); i++ ) {
+    ApiPresence presence = getApiPresence( apis[i] );
+    if ( presence == API_ABSENT ) continue;
     openRtApi( apis[i] );
-    if ( rtapi_ && rtapi_->getDeviceCount() ) break;
+    if ( rtapi_ && ( presence == API_PRESENT || rtapi_->getDeviceCount() ) ) break;
   }
 
+  // Without any API present, use the last one as before.
+  if ( rtapi_ == 0 && apis.size() ) openRtApi( apis.back() );
+
   if ( rtapi_ ) return;
 
   // It should not be possible to get here because the preprocessor
@@ -216,6 +495,29 @@ RtAudio :: ~RtAudio()
     delete rtapi_;
 }
 
+RtAudio *RtAudio :: createStreamHandle( void )
+{
+  RtAudio *audio = new RtAudio( rtapi_->getCurrentApi() );
+  audio->rtapi_->shareContext( rtapi_ );
+  return audio;
+}
+
+void RtAudio :: startStreamGroup( const std::vector<RtAudio *> &streams )
+{
+  std::vector<RtApi *> apis;
+  for ( unsigned int i=0; i<streams.size(); i++ )
+    apis.push_back( streams[i]->rtapi_ );
+  RtApi::startStreamGroup( apis );
+}
+
+void RtAudio :: stopStreamGroup( const std::vector<RtAudio *> &streams )
+{
+  std::vector<RtApi *> apis;
+  for ( unsigned int i=0; i<streams.size(); i++ )
+    apis.push_back( streams[i]->rtapi_ );
+  RtApi::stopStreamGroup( apis );
+}
+
 void RtAudio :: openStream( RtAudio::StreamParameters *outputParameters,
                             RtAudio::StreamParameters *inputParameters,
                             RtAudioFormat format, unsigned int sampleRate,
@@ -246,13 +548,111 @@ RtApi :: RtApi()
   MUTEX_INITIALIZE( &stream_.mutex );
   showWarnings_ = true;
   firstErrorOccurred_ = false;
+  deviceCallback_ = 0;
+  deviceUserData_ = 0;
+
+  context_ = new RtApiContext;
+  MUTEX_INITIALIZE( &context_->mutex );
+  context_->apis.push_back( this );
+  aggregateHandle_ = 0;
+  blockingHandle_ = 0;
+  blockAdapterHandle_ = 0;
 }
 
 RtApi :: ~RtApi()
 {
+  closeAggregateStream();
+  closeBlockAdapter();
+  closeBlockingStream();
+  releaseContext();
   MUTEX_DESTROY( &stream_.mutex );
 }
 
+void RtApi :: shareContext( RtApi *api )
+{
+  if ( api->context_ == context_ ) return;
+
+  releaseContext();
+  context_ = api->context_;
+  MUTEX_LOCK( &context_->mutex );
+  context_->apis.push_back( this );
+  MUTEX_UNLOCK( &context_->mutex );
+}
+
+void RtApi :: releaseContext( void )
+{
+  MUTEX_LOCK( &context_->mutex );
+  std::vector<RtApi *>::iterator it = std::find( context_->apis.begin(), context_->apis.end(), this );
+  if ( it != context_->apis.end() ) context_->apis.erase( it );
+  bool isLast = context_->apis.empty();
+  MUTEX_UNLOCK( &context_->mutex );
+
+  if ( isLast ) {
+    if ( context_->apiHandle && context_->closeApiHandle )
+      context_->closeApiHandle( context_->apiHandle );
+    MUTEX_DESTROY( &context_->mutex );
+    delete context_;
+  }
+  context_ = 0;
+}
+
+bool RtApi :: isDeviceOpen( unsigned int device )
+{
+  bool isOpen = false;
+  MUTEX_LOCK( &context_->mutex );
+  for ( unsigned int i=0; i<context_->apis.size(); i++ ) {
+    RtApiStream &stream = context_->apis[i]->stream_;
+    if ( stream.state != STREAM_CLOSED &&
+         ( stream.device[0] == device || stream.device[1] == device ) ) {
+      isOpen = true;
+      break;
+    }
+  }
+  MUTEX_UNLOCK( &context_->mutex );
+  return isOpen;
+}
+
+unsigned int RtApi :: getSavedDeviceCount( void )
+{
+  MUTEX_LOCK( &context_->mutex );
+  unsigned int nDevices = (unsigned int) context_->devices.size();
+  MUTEX_UNLOCK( &context_->mutex );
+  return nDevices;
+}
+
+bool RtApi :: isContextShared( void )
+{
+  MUTEX_LOCK( &context_->mutex );
+  bool isShared = context_->apis.size() > 1;
+  MUTEX_UNLOCK( &context_->mutex );
+  return isShared;
+}
+
+bool RtApi :: getSavedDeviceInfo( unsigned int device, RtAudio::DeviceInfo &info )
+{
+  bool found = false;
+  MUTEX_LOCK( &context_->mutex );
+  if ( device < context_->devices.size() ) {
+    info = context_->devices[ device ];
+    found = true;
+  }
+  MUTEX_UNLOCK( &context_->mutex );
+  return found;
+}
+
+void RtApi :: setSavedDeviceInfo( const std::vector<RtAudio::DeviceInfo> &devices )
+{
+  MUTEX_LOCK( &context_->mutex );
+  context_->devices = devices;
+  MUTEX_UNLOCK( &context_->mutex );
+}
+
+// Defined with the blocking i/o and block adapter functions below.
+static int blockingCallbackHandler( void *outputBuffer, void *inputBuffer, unsigned int nFrames,
+                                    double streamTime, RtAudioStreamStatus status, void *userData );
+static int blockAdapterHandler( void *outputBuffer, void *inputBuffer, unsigned int nFrames,
+                                double streamTime, RtAudioStreamStatus status, void *userData );
+
 void RtApi :: openStream( RtAudio::StreamParameters *oParams,
                           RtAudio::StreamParameters *iParams,
                           RtAudioFormat format, unsigned int sampleRate,
@@ -269,6 +669,9 @@ void RtApi :: openStream( RtAudio::StreamParameters *oParams,
 
   // Clear stream information potentially left from a previously open stream.
   clearStreamInfo();
+  closeAggregateStream();
+  closeBlockAdapter();
+  closeBlockingStream();
 
   if ( oParams && oParams->nChannels < 1 ) {
     errorText_ = "RtApi::openStream: a non-NULL output StreamParameters structure cannot have an nChannels value less than one.";
@@ -294,6 +697,28 @@ void RtApi :: openStream( RtAudio::StreamParameters *oParams,
     return;
   }
 
+  // Devices given by identifier are opened by their current index.
+  RtAudio::StreamParameters outputById, inputById;
+  if ( oParams && !oParams->deviceIdentifier.empty() ) {
+    outputById = *oParams;
+    if ( !findDevice( oParams->deviceIdentifier, &outputById.deviceId ) ) {
+      errorText_ = "RtApi::openStream: output device identifier (" + oParams->deviceIdentifier + ") not found.";
+      error( RtAudioError::INVALID_USE );
+      return;
+    }
+    oParams = &outputById;
+  }
+
+  if ( iParams && !iParams->deviceIdentifier.empty() ) {
+    inputById = *iParams;
+    if ( !findDevice( iParams->deviceIdentifier, &inputById.deviceId ) ) {
+      errorText_ = "RtApi::openStream: input device identifier (" + iParams->deviceIdentifier + ") not found.";
+      error( RtAudioError::INVALID_USE );
+      return;
+    }
+    iParams = &inputById;
+  }
+
   unsigned int nDevices = getDeviceCount();
   unsigned int oChannels = 0;
   if ( oParams ) {
@@ -315,6 +740,44 @@ void RtApi :: openStream( RtAudio::StreamParameters *oParams,
     }
   }
 
+  bool isAggregate = false;
+  RtAudio::StreamParameters *params[2] = { oParams, iParams };
+  for ( int mode=0; mode<2; mode++ ) {
+    if ( params[mode] == NULL ) continue;
+    std::vector<RtAudio::AggregateDevice> &devices = params[mode]->aggregateDevices;
+    for ( unsigned int i=0; i<devices.size(); i++ ) {
+      if ( devices[i].deviceId >= nDevices || devices[i].nChannels < 1 ) {
+        errorText_ = "RtApi::openStream: aggregate device parameter value is invalid.";
+        error( RtAudioError::INVALID_USE );
+        return;
+      }
+      isAggregate = true;
+    }
+  }
+
+  // With independent input and output clocks, the input device is
+  // opened as the first secondary device of an aggregate stream.
+  RtAudio::StreamParameters independentInput;
+  if ( options && ( options->flags & RTAUDIO_INDEPENDENT_DUPLEX ) && oChannels > 0 && iChannels > 0 ) {
+    RtAudio::AggregateDevice input;
+    input.deviceId = iParams->deviceId;
+    input.nChannels = iChannels;
+    input.firstChannel = iParams->firstChannel;
+    independentInput.aggregateDevices.push_back( input );
+    independentInput.aggregateDevices.insert( independentInput.aggregateDevices.end(),
+                                              iParams->aggregateDevices.begin(),
+                                              iParams->aggregateDevices.end() );
+    iParams = &independentInput;
+    iChannels = 0;
+    isAggregate = true;
+  }
+
+  // The block size requested for the callback, if it must be kept.
+  unsigned int blockFrames = 0;
+  if ( options && ( options->flags & RTAUDIO_FIXED_BLOCK_SIZE ) && bufferFrames )
+    blockFrames = *bufferFrames;
+  if ( options ) stream_.flags = options->flags;
+
   bool result;
 
   if ( oChannels > 0 ) {
@@ -338,65 +801,1349 @@ void RtApi :: openStream( RtAudio::StreamParameters *oParams,
     }
   }
 
+  stream_.callbackInfo.errorCallback = (void *) errorCallback;
+
+  // The blocking i/o handler and the block adapter see the combined
+  // channels of an aggregate stream.
+  unsigned int channels[2] = { oChannels, iChannels };
+  RtAudio::StreamParameters *streamParams[2] = { oParams, iParams };
+  for ( int mode=0; mode<2; mode++ ) {
+    if ( streamParams[mode] == NULL ) continue;
+    for ( unsigned int i=0; i<streamParams[mode]->aggregateDevices.size(); i++ )
+      channels[mode] += streamParams[mode]->aggregateDevices[i].nChannels;
+  }
+  if ( blockFrames == stream_.bufferSize ) blockFrames = 0;
+
+  // Without a callback function, the stream is serviced by the
+  // blocking i/o handler.
+  if ( callback == NULL ) {
+    if ( openBlockingStream( channels, blockFrames ? blockFrames : stream_.bufferSize ) == false ) {
+      closeStream();
+      error( RtAudioError::INVALID_USE );
+      return;
+    }
+    callback = blockingCallbackHandler;
+    userData = (void *) this;
+  }
+
+  if ( blockFrames ) {
+    if ( openBlockAdapter( channels, blockFrames, callback, userData ) == false ) {
+      closeStream();
+      closeBlockingStream();
+      error( RtAudioError::SYSTEM_ERROR );
+      return;
+    }
+    callback = blockAdapterHandler;
+    userData = (void *) this;
+    *bufferFrames = blockFrames;
+  }
+
   stream_.callbackInfo.callback = (void *) callback;
   stream_.callbackInfo.userData = userData;
-  stream_.callbackInfo.errorCallback = (void *) errorCallback;
+
+  if ( isAggregate ) {
+    result = openAggregateStream( oParams, iParams, callback, userData, options );
+    if ( result == false ) {
+      closeStream();
+      closeBlockAdapter();
+      closeBlockingStream();
+      error( RtAudioError::SYSTEM_ERROR );
+      return;
+    }
+  }
 
   if ( options ) options->numberOfBuffers = stream_.nBuffers;
   stream_.state = STREAM_STOPPED;
 }
 
+std::vector<RtAudio::DeviceInfo> RtApi :: getDevices( bool /*probeCapabilities*/ )
+{
+  // Should be reimplemented in subclasses that can probe all the
+  // devices together, or skip the probe of their capabilities.
+  std::vector<RtAudio::DeviceInfo> devices( getDeviceCount() );
+  for ( unsigned int i=0; i<devices.size(); i++ )
+    devices[i] = getDeviceInfo( i );
+  return devices;
+}
+
+bool RtApi :: findDevice( const std::string &identifier, unsigned int *device )
+{
+  // Should be reimplemented in subclasses that can find a device
+  // without probing all of them.
+  std::vector<RtAudio::DeviceInfo> devices = getDevices( false );
+  for ( unsigned int i=0; i<devices.size(); i++ ) {
+    if ( !devices[i].identifier.empty() && devices[i].identifier == identifier ) {
+      *device = i;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool RtApi :: setDeviceCallback( RtAudioDeviceCallback callback, void * /*userData*/ )
+{
+  // Should be reimplemented in subclasses that can report device
+  // changes.
+  if ( callback == 0 ) return true;
+  errorText_ = "RtApi::setDeviceCallback: device change notifications are not supported by this API.";
+  error( RtAudioError::WARNING );
+  return false;
+}
+
 unsigned int RtApi :: getDefaultInputDevice( void )
 {
   // Should be implemented in subclasses if possible.
   return 0;
 }
 
-unsigned int RtApi :: getDefaultOutputDevice( void )
-{
-  // Should be implemented in subclasses if possible.
-  return 0;
+unsigned int RtApi :: getDefaultOutputDevice( void )
+{
+  // Should be implemented in subclasses if possible.
+  return 0;
+}
+
+void RtApi :: closeStream( void )
+{
+  // MUST be implemented in subclasses!
+  return;
+}
+
+void RtApi :: tickStream( void )
+{
+  // Should be implemented in subclasses that drive their streams
+  // from an internal callback thread.
+  verifyStream();
+  errorText_ = "RtApi::tickStream(): manual stream pumping is not supported by this API!";
+  error( RtAudioError::INVALID_USE );
+}
+
+// The longest time that startStreamGroup() waits for the armed
+// streams to prefill their output, in seconds.
+static const double GROUP_PRIME_TIMEOUT = 0.5;
+
+// The time between the moment all streams of a group are ready and
+// their start deadline, in seconds.
+static const double GROUP_START_DELAY = 0.002;
+
+void rtaudioYield( void )
+{
+#if defined(_WIN32)
+  SwitchToThread();
+#else
+  sched_yield();
+#endif
+}
+
+static void sleepUntilMonotonicTime( double deadline )
+{
+#if defined(__linux__)
+  struct timespec time;
+  time.tv_sec = (time_t) deadline;
+  time.tv_nsec = (long) ( ( deadline - time.tv_sec ) * 1e9 );
+  while ( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &time, NULL ) == EINTR );
+#elif defined(CLOCK_MONOTONIC)
+  double delay = deadline - getMonotonicTime();
+  if ( delay <= 0.0 ) return;
+  struct timespec time;
+  time.tv_sec = (time_t) delay;
+  time.tv_nsec = (long) ( ( delay - time.tv_sec ) * 1e9 );
+  nanosleep( &time, NULL );
+#else
+  (void) deadline;
+#endif
+}
+
+void RtApi :: startStreamGroup( const std::vector<RtApi *> &apis )
+{
+  unsigned int i;
+  for ( i=0; i<apis.size(); i++ ) {
+    if ( !apis[i]->isStreamOpen() )
+      throw( RtAudioError( "RtApi::startStreamGroup: a stream is not open!", RtAudioError::INVALID_USE ) );
+    if ( apis[i]->isStreamRunning() )
+      throw( RtAudioError( "RtApi::startStreamGroup: a stream is already running!", RtAudioError::INVALID_USE ) );
+  }
+
+  // Start the streams whose devices can be triggered later, such that
+  // their callbacks begin to prefill the output buffers.
+  // If a stream fails, those armed before it get their automatic start
+  // back and are stopped again, such that no stream of the group is
+  // left waiting for a trigger.
+  std::vector<bool> isArmed( apis.size(), false );
+  try {
+    for ( i=0; i<apis.size(); i++ )
+      isArmed[i] = apis[i]->armStreamStart();
+  }
+  catch ( RtAudioError & ) {
+    for ( unsigned int j=0; j<i; j++ ) {
+      if ( !isArmed[j] ) continue;
+      apis[j]->completeStreamStart();
+      apis[j]->unlinkStream();
+      try {
+        if ( apis[j]->isStreamRunning() ) apis[j]->abortStream();
+      }
+      catch ( RtAudioError & ) {
+      }
+    }
+    throw;
+  }
+
+  // Link the devices of the armed streams to the first one, such that
+  // triggering it starts them all.
+  std::vector<bool> isLinked( apis.size(), false );
+  int reference = -1;
+  for ( i=0; i<apis.size(); i++ ) {
+    if ( !isArmed[i] ) continue;
+    if ( reference < 0 ) reference = i;
+    else isLinked[i] = apis[reference]->linkStream( apis[i] );
+  }
+
+  double timeout = getMonotonicTime() + GROUP_PRIME_TIMEOUT;
+  for ( i=0; i<apis.size(); i++ ) {
+    while ( isArmed[i] && !apis[i]->isStreamPrimed() && getMonotonicTime() < timeout )
+      sleepUntilMonotonicTime( getMonotonicTime() + 0.001 );
+  }
+
+  // Start the devices that are not linked as close as possible to a
+  // common deadline.
+  double deadline = getMonotonicTime() + GROUP_START_DELAY;
+  sleepUntilMonotonicTime( deadline );
+  for ( i=0; i<apis.size(); i++ ) {
+    if ( isLinked[i] ) continue;
+    if ( isArmed[i] )
+      apis[i]->triggerStreamStart();
+    else {
+      apis[i]->startStream();
+      apis[i]->stream_.startTime = getMonotonicTime();
+    }
+  }
+
+  for ( i=0; i<apis.size(); i++ ) {
+    if ( isArmed[i] ) apis[i]->completeStreamStart();
+    apis[i]->stream_.startOffset = apis[i]->stream_.startTime - deadline;
+  }
+}
+
+void RtApi :: stopStreamGroup( const std::vector<RtApi *> &apis )
+{
+  unsigned int i;
+  for ( i=0; i<apis.size(); i++ ) {
+    if ( !apis[i]->isStreamOpen() )
+      throw( RtAudioError( "RtApi::stopStreamGroup: a stream is not open!", RtAudioError::INVALID_USE ) );
+  }
+
+  // Release the links first, such that each stream can drain its
+  // output on its own.
+  for ( i=0; i<apis.size(); i++ )
+    apis[i]->unlinkStream();
+
+  for ( i=0; i<apis.size(); i++ ) {
+    if ( apis[i]->isStreamRunning() ) apis[i]->stopStream();
+  }
+}
+
+bool RtApi :: armStreamStart( void )
+{
+  // Should be implemented in subclasses that can start their devices
+  // independently of the stream state.
+  return false;
+}
+
+bool RtApi :: linkStream( RtApi * /*api*/ )
+{
+  return false;
+}
+
+void RtApi :: unlinkStream( void )
+{
+}
+
+bool RtApi :: isStreamPrimed( void )
+{
+  return true;
+}
+
+void RtApi :: triggerStreamStart( void )
+{
+  startStream();
+}
+
+void RtApi :: completeStreamStart( void )
+{
+  stream_.startTime = getMonotonicTime();
+}
+
+unsigned int RtApi :: getStreamPollDescriptors( struct pollfd * /*pfds*/, unsigned int /*space*/ )
+{
+  // Should be implemented in subclasses that can be serviced by an
+  // RtAudioEngine.  A return value of zero indicates that polling is
+  // not supported.
+  return 0;
+}
+
+bool RtApi :: isStreamReady( void )
+{
+  // Should be implemented in subclasses that can be serviced by an
+  // RtAudioEngine.
+  return stream_.state == STREAM_RUNNING;
+}
+
+bool RtApi :: probeDeviceOpen( unsigned int /*device*/, StreamMode /*mode*/, unsigned int /*channels*/,
+                               unsigned int /*firstChannel*/, unsigned int /*sampleRate*/,
+                               RtAudioFormat /*format*/, unsigned int * /*bufferSize*/,
+                               RtAudio::StreamOptions * /*options*/ )
+{
+  // MUST be implemented in subclasses!
+  return FAILURE;
+}
+
+void RtApi :: tickStreamTime( void )
+{
+  // Subclasses that do not provide their own implementation of
+  // getStreamTime should call this function once per buffer I/O to
+  // provide basic stream time support.
+
+  stream_.streamTime += ( stream_.bufferSize * 1.0 / stream_.sampleRate );
+
+#if defined( HAVE_GETTIMEOFDAY )
+  gettimeofday( &stream_.lastTickTimestamp, NULL );
+#endif
+}
+
+// *************************************************** //
+//
+// RtApi aggregate stream definitions.
+//
+// The secondary devices of an aggregate stream run their own callback
+// threads and exchange audio with the primary stream through lock-free
+// FIFOs.  A delay-locked loop estimates the actual sample rate of each
+// device, and an adaptive resampler compensates the drift between the
+// primary and secondary clocks.
+//
+// *************************************************** //
+
+// The bandwidth of the delay-locked loops, in Hz.
+static const double AGGREGATE_DLL_BANDWIDTH = 0.5;
+
+// The resampling ratio is corrected by this gain times the deviation
+// of a FIFO from its target fill, in seconds, within the given limit.
+static const double AGGREGATE_FILL_GAIN = 0.1;
+static const double AGGREGATE_MAX_CORRECTION = 0.005;
+
+// A delay-locked loop that filters the callback times of a device to
+// estimate its actual sample rate (see F. Adriaensen, "Using a DLL to
+// filter time", 2005).  It is updated by the thread of its device,
+// and the estimate is published with a sequence count, such that the
+// thread of another device reads it without tearing.
+struct RateEstimator {
+  double nominalRate;
+  double rate; // The current estimate, in frames per second.
+  double period;
+  double t1;
+  double b, c;
+  unsigned int nFrames;
+  bool isLocked;
+  volatile double published;
+  volatile unsigned int sequence; // Odd while the estimate is written.
+
+  RateEstimator()
+    :nominalRate(0.0), rate(0.0), period(0.0), t1(0.0), b(0.0), c(0.0), nFrames(0), isLocked(false),
+     published(0.0), sequence(0) {}
+
+  // Returns the last published estimate, from any thread.
+  double getRate( void ) const
+  {
+    unsigned int start;
+    double value;
+    do {
+      start = sequence;
+      RTAUDIO_MEMORY_BARRIER();
+      value = published;
+      RTAUDIO_MEMORY_BARRIER();
+    } while ( ( start & 1 ) || start != sequence );
+    return value;
+  }
+
+  void publish( void )
+  {
+    sequence = sequence + 1;
+    RTAUDIO_MEMORY_BARRIER();
+    published = rate;
+    RTAUDIO_MEMORY_BARRIER();
+    sequence = sequence + 1;
+  }
+
+  void reset( double sampleRate, unsigned int frames )
+  {
+    nominalRate = sampleRate;
+    rate = sampleRate;
+    publish();
+    nFrames = frames;
+    period = frames / sampleRate;
+    double omega = 2.0 * 3.14159265358979 * AGGREGATE_DLL_BANDWIDTH * period;
+    b = sqrt( 2.0 ) * omega;
+    c = omega * omega;
+    isLocked = false;
+  }
+
+  // Returns false when the loop had to lock again, for example after
+  // the stream was stopped.
+  bool update( double now )
+  {
+    double error = now - t1;
+    if ( !isLocked || fabs( error ) > 4.0 * period ) {
+      t1 = now + period;
+      bool wasLocked = isLocked;
+      isLocked = true;
+      return !wasLocked;
+    }
+
+    t1 += b * error + period;
+    period += c * error;
+    if ( fabs( nFrames / period - nominalRate ) > 0.01 * nominalRate ) {
+      // Not a plausible clock drift, so start over.
+      period = nFrames / nominalRate;
+      rate = nominalRate;
+      publish();
+      isLocked = false;
+      return true;
+    }
+    rate = nFrames / period;
+    publish();
+    return true;
+  }
+};
+
+// An adaptive resampler using 4-point cubic (Catmull-Rom)
+// interpolation of interleaved float frames.  It keeps the last input
+// frames between calls, such that blocks can be processed seamlessly.
+class AggregateResampler {
+ public:
+  void reset( unsigned int channels )
+  {
+    channels_ = channels;
+    history_.assign( 4 * channels, 0.0f );
+    position_ = 0.0;
+  }
+
+  // Produces up to maxOut output frames, consuming 'step' input frames
+  // per output frame.  The number of input frames used is returned
+  // in *used.
+  unsigned int process( const float *in, unsigned int nIn, float *out, unsigned int maxOut,
+                        double step, unsigned int *used )
+  {
+    unsigned int nOut = 0, i = 0, k;
+    float *f = &history_[0];
+    while ( nOut < maxOut ) {
+      while ( position_ >= 1.0 ) {
+        if ( i == nIn ) goto done;
+        memmove( f, f + channels_, 3 * channels_ * sizeof( float ) );
+        memcpy( f + 3 * channels_, in + i * channels_, channels_ * sizeof( float ) );
+        position_ -= 1.0;
+        i++;
+      }
+
+      float t = (float) position_;
+      for ( k=0; k<channels_; k++ ) {
+        float y0 = f[k], y1 = f[channels_ + k], y2 = f[2 * channels_ + k], y3 = f[3 * channels_ + k];
+        float c1 = 0.5f * ( y2 - y0 );
+        float c2 = y0 - 2.5f * y1 + 2.0f * y2 - 0.5f * y3;
+        float c3 = 0.5f * ( y3 - y0 ) + 1.5f * ( y1 - y2 );
+        out[k] = ( ( c3 * t + c2 ) * t + c1 ) * t + y1;
+      }
+      out += channels_;
+      position_ += step;
+      nOut++;
+    }
+
+  done:
+    *used = i;
+    return nOut;
+  }
+
+ private:
+  std::vector<float> history_;
+  unsigned int channels_;
+  double position_;
+};
+
+// A secondary device of an aggregate stream.
+struct AggregateSecondary {
+  RtApi *api;
+  bool isInput;
+  unsigned int nChannels;
+  unsigned int target;        // FIFO fill, in frames, at which the consumer starts.
+  RtAudioRingBuffer<float> fifo;
+  AggregateResampler resampler;
+  RateEstimator rate;
+  bool isPrimed;              // Set and cleared by the FIFO consumer only.
+  volatile bool xrun;
+  RtApi::ConvertInfo convertInfo;
+
+  AggregateSecondary()
+    :api(0), isInput(false), nChannels(0), target(0), isPrimed(false), xrun(false) {}
+};
+
+struct AggregateInfo {
+  RtAudioCallback callback;
+  void *userData;
+  char *userBuffer[2];        // The combined user buffers.
+  RtApi::ConvertInfo primaryConvert[2];
+  std::vector<AggregateSecondary *> secondaries;
+  std::vector<float> input;   // Resampler input frames.
+  std::vector<float> output;  // Resampler output frames.
+  unsigned int maxFrames;     // The capacity of the resampler buffers.
+  RateEstimator rate;
+  unsigned long addedLatency[2];  // The elastic buffers, in primary frames.
+  unsigned long deviceLatency[2]; // Secondary devices without a primary counterpart.
+
+  AggregateInfo()
+    :callback(0), userData(0), maxFrames(0)
+  {
+    for ( int i=0; i<2; i++ ) {
+      userBuffer[i] = 0;
+      addedLatency[i] = 0;
+      deviceLatency[i] = 0;
+    }
+  }
+};
+
+static int aggregateCallbackHandler( void *outputBuffer, void *inputBuffer, unsigned int /*nFrames*/,
+                                     double streamTime, RtAudioStreamStatus status, void *userData )
+{
+  RtApi *object = (RtApi *) userData;
+  return object->aggregateCallbackEvent( outputBuffer, inputBuffer, streamTime, status );
+}
+
+// The callback of the secondary devices, which runs on their own clock.
+static int aggregateSecondaryCallback( void *outputBuffer, void *inputBuffer, unsigned int nFrames,
+                                       double /*streamTime*/, RtAudioStreamStatus status, void *userData )
+{
+  AggregateSecondary *secondary = (AggregateSecondary *) userData;
+  secondary->rate.update( getMonotonicTime() );
+  if ( status ) secondary->xrun = true;
+
+  if ( inputBuffer ) {
+    if ( secondary->fifo.write( (float *) inputBuffer, nFrames ) < nFrames )
+      secondary->xrun = true;
+    return 0;
+  }
+
+  float *out = (float *) outputBuffer;
+  unsigned int n = 0;
+  if ( !secondary->isPrimed && secondary->fifo.readAvailable() >= secondary->target )
+    secondary->isPrimed = true;
+  if ( secondary->isPrimed ) {
+    n = secondary->fifo.read( out, nFrames );
+    if ( n < nFrames ) {
+      secondary->isPrimed = false;
+      secondary->xrun = true;
+    }
+  }
+  memset( out + n * secondary->nChannels, 0, ( nFrames - n ) * secondary->nChannels * sizeof( float ) );
+  return 0;
+}
+
+// Returns the corrected ratio of input to output frames for a FIFO.
+static double getAggregateStep( double ratio, AggregateSecondary *secondary )
+{
+  double error = ( (double) secondary->fifo.readAvailable() - secondary->target ) / secondary->rate.nominalRate;
+  double correction = AGGREGATE_FILL_GAIN * error;
+  if ( correction > AGGREGATE_MAX_CORRECTION ) correction = AGGREGATE_MAX_CORRECTION;
+  else if ( correction < -AGGREGATE_MAX_CORRECTION ) correction = -AGGREGATE_MAX_CORRECTION;
+  return ratio * ( 1.0 + correction );
+}
+
+bool RtApi :: openAggregateStream( RtAudio::StreamParameters *oParams,
+                                   RtAudio::StreamParameters *iParams,
+                                   RtAudioCallback callback, void *userData,
+                                   RtAudio::StreamOptions *options )
+{
+  AggregateInfo *info = new AggregateInfo;
+  info->callback = callback;
+  info->userData = userData;
+  info->rate.reset( stream_.sampleRate, stream_.bufferSize );
+  aggregateHandle_ = (void *) info;
+
+  // The secondary devices use float samples with interleaved channels,
+  // which the resamplers process directly.
+  RtAudio::StreamOptions secondaryOptions;
+  if ( options ) {
+    secondaryOptions.flags = options->flags & ~( RTAUDIO_NONINTERLEAVED | RTAUDIO_MANUAL_PUMP |
+                                                RTAUDIO_INDEPENDENT_DUPLEX | RTAUDIO_FIXED_BLOCK_SIZE );
+    secondaryOptions.numberOfBuffers = options->numberOfBuffers;
+    secondaryOptions.streamName = options->streamName;
+    secondaryOptions.priority = options->priority;
+  }
+
+  RtAudio::StreamParameters *params[2] = { oParams, iParams };
+  unsigned int mode, i, maxChannels = 0;
+  for ( mode=0; mode<2; mode++ ) {
+    if ( params[mode] == NULL ) continue;
+    std::vector<RtAudio::AggregateDevice> &devices = params[mode]->aggregateDevices;
+    unsigned int totalChannels = stream_.nUserChannels[mode];
+    for ( i=0; i<devices.size(); i++ )
+      totalChannels += devices[i].nChannels;
+
+    unsigned int firstChannel = stream_.nUserChannels[mode];
+    for ( i=0; i<devices.size(); i++ ) {
+      AggregateSecondary *secondary = new AggregateSecondary;
+      info->secondaries.push_back( secondary );
+      secondary->isInput = ( mode == INPUT );
+      secondary->nChannels = devices[i].nChannels;
+      secondary->api = createRtApi( getCurrentApi() );
+      secondary->api->shareContext( this );
+      secondary->api->showWarnings( showWarnings_ );
+
+      RtAudio::StreamParameters parameters;
+      parameters.deviceId = devices[i].deviceId;
+      parameters.nChannels = devices[i].nChannels;
+      parameters.firstChannel = devices[i].firstChannel;
+      unsigned int bufferFrames = stream_.bufferSize;
+      try {
+        secondary->api->openStream( mode == OUTPUT ? &parameters : NULL, mode == INPUT ? &parameters : NULL,
+                                    RTAUDIO_FLOAT32, stream_.sampleRate, &bufferFrames,
+                                    aggregateSecondaryCallback, (void *) secondary, &secondaryOptions, NULL );
+      }
+      catch ( RtAudioError &e ) {
+        errorStream_ << "RtApi::openStream: error opening aggregate device " << devices[i].deviceId << ": " << e.getMessage();
+        errorText_ = errorStream_.str();
+        closeAggregateStream();
+        return FAILURE;
+      }
+
+      double sampleRate = secondary->api->getStreamSampleRate();
+      secondary->rate.reset( sampleRate, bufferFrames );
+      secondary->target = bufferFrames + stream_.bufferSize;
+      secondary->fifo.allocate( 4 * secondary->target, secondary->nChannels );
+      secondary->resampler.reset( secondary->nChannels );
+      setAggregateConvertInfo( secondary->convertInfo, mode == INPUT, RTAUDIO_FLOAT32,
+                               secondary->nChannels, true, firstChannel, totalChannels );
+      firstChannel += secondary->nChannels;
+      if ( secondary->nChannels > maxChannels ) maxChannels = secondary->nChannels;
+
+      unsigned long latency = (unsigned long) ( secondary->target * stream_.sampleRate / sampleRate );
+      if ( latency > info->addedLatency[mode] ) info->addedLatency[mode] = latency;
+      if ( stream_.nUserChannels[mode] == 0 ) {
+        latency = (unsigned long) ( secondary->api->getStreamLatency() * stream_.sampleRate / sampleRate );
+        if ( latency > info->deviceLatency[mode] ) info->deviceLatency[mode] = latency;
+      }
+    }
+
+    // Allocate the combined user buffer.
+    info->userBuffer[mode] = (char *) calloc( totalChannels * stream_.bufferSize, formatBytes( stream_.userFormat ) );
+    if ( info->userBuffer[mode] == NULL ) {
+      errorText_ = "RtApi::openStream: error allocating aggregate user buffer memory.";
+      closeAggregateStream();
+      return FAILURE;
+    }
+    setAggregateConvertInfo( info->primaryConvert[mode], mode == INPUT, stream_.userFormat,
+                             stream_.nUserChannels[mode], stream_.userInterleaved, 0, totalChannels );
+  }
+
+  // The resampler buffers allow for the largest possible ratio.
+  info->maxFrames = 2 * stream_.bufferSize + 8;
+  info->input.resize( info->maxFrames * maxChannels );
+  info->output.resize( info->maxFrames * maxChannels );
+
+  // Replace the user callback by the aggregate handler, then start the
+  // secondary devices, which run until the stream is closed.
+  stream_.callbackInfo.callback = (void *) aggregateCallbackHandler;
+  stream_.callbackInfo.userData = (void *) this;
+  for ( i=0; i<info->secondaries.size(); i++ ) {
+    try {
+      info->secondaries[i]->api->startStream();
+    }
+    catch ( RtAudioError &e ) {
+      errorText_ = "RtApi::openStream: error starting aggregate device: " + e.getMessage();
+      closeAggregateStream();
+      return FAILURE;
+    }
+  }
+
+  return SUCCESS;
+}
+
+void RtApi :: closeAggregateStream( void )
+{
+  AggregateInfo *info = (AggregateInfo *) aggregateHandle_;
+  if ( info == 0 ) return;
+
+  for ( unsigned int i=0; i<info->secondaries.size(); i++ ) {
+    AggregateSecondary *secondary = info->secondaries[i];
+    if ( secondary->api ) {
+      if ( secondary->api->isStreamOpen() ) secondary->api->closeStream();
+      delete secondary->api;
+    }
+    delete secondary;
+  }
+
+  for ( int i=0; i<2; i++ )
+    if ( info->userBuffer[i] ) free( info->userBuffer[i] );
+
+  delete info;
+  aggregateHandle_ = 0;
+}
+
+void RtApi :: setAggregateConvertInfo( ConvertInfo &info, bool toUser, RtAudioFormat format,
+                                       unsigned int channels, bool interleaved,
+                                       unsigned int firstChannel, unsigned int totalChannels )
+{
+  // The combined user buffer holds the channels of all devices in the
+  // user format and layout.
+  int deviceJump = interleaved ? channels : 1;
+  int userJump = stream_.userInterleaved ? totalChannels : 1;
+  std::vector<int> deviceOffset, userOffset;
+  for ( unsigned int k=0; k<channels; k++ ) {
+    deviceOffset.push_back( interleaved ? k : k * stream_.bufferSize );
+    userOffset.push_back( stream_.userInterleaved ? firstChannel + k : ( firstChannel + k ) * stream_.bufferSize );
+  }
+
+  info.channels = channels;
+  if ( toUser ) {
+    info.inJump = deviceJump;
+    info.outJump = userJump;
+    info.inFormat = format;
+    info.outFormat = stream_.userFormat;
+    info.inOffset = deviceOffset;
+    info.outOffset = userOffset;
+  }
+  else {
+    info.inJump = userJump;
+    info.outJump = deviceJump;
+    info.inFormat = stream_.userFormat;
+    info.outFormat = format;
+    info.inOffset = userOffset;
+    info.outOffset = deviceOffset;
+  }
+}
+
+int RtApi :: aggregateCallbackEvent( void *outputBuffer, void *inputBuffer,
+                                     double streamTime, RtAudioStreamStatus status )
+{
+  AggregateInfo *info = (AggregateInfo *) aggregateHandle_;
+  unsigned int i, nFrames = stream_.bufferSize, used, produced;
+
+  // After a pause, the buffered input is stale and any xruns were
+  // caused by the primary stream not running.
+  bool isContinuous = info->rate.update( getMonotonicTime() );
+  for ( i=0; i<info->secondaries.size(); i++ ) {
+    AggregateSecondary *secondary = info->secondaries[i];
+    if ( !isContinuous ) {
+      secondary->xrun = false;
+      if ( secondary->isInput ) secondary->isPrimed = false;
+    }
+    if ( secondary->xrun ) {
+      secondary->xrun = false;
+      status |= secondary->isInput ? RTAUDIO_INPUT_OVERFLOW : RTAUDIO_OUTPUT_UNDERFLOW;
+    }
+  }
+
+  // The primary device may not handle a direction with secondary
+  // devices, as with independent duplex streams.
+  if ( info->userBuffer[1] ) {
+    if ( inputBuffer )
+      convertBuffer( info->userBuffer[1], (char *) inputBuffer, info->primaryConvert[1] );
+    for ( i=0; i<info->secondaries.size(); i++ ) {
+      AggregateSecondary *secondary = info->secondaries[i];
+      if ( !secondary->isInput ) continue;
+
+      // Wait until the FIFO holds the target latency, dropping any
+      // older frames.
+      produced = 0;
+      unsigned int available = secondary->fifo.readAvailable();
+      if ( !secondary->isPrimed && available >= secondary->target ) {
+        secondary->fifo.commitRead( available - secondary->target );
+        secondary->resampler.reset( secondary->nChannels );
+        secondary->isPrimed = true;
+      }
+      if ( secondary->isPrimed ) {
+        double step = getAggregateStep( secondary->rate.getRate() / info->rate.rate, secondary );
+        unsigned int needed = (unsigned int) ( nFrames * step ) + 4;
+        if ( needed > info->maxFrames ) needed = info->maxFrames;
+        unsigned int n = secondary->fifo.peek( &info->input[0], needed );
+        produced = secondary->resampler.process( &info->input[0], n, &info->output[0], nFrames, step, &used );
+        secondary->fifo.commitRead( used );
+        if ( produced < nFrames ) {
+          secondary->isPrimed = false;
+          status |= RTAUDIO_INPUT_OVERFLOW;
+        }
+      }
+      memset( &info->output[produced * secondary->nChannels], 0,
+              ( nFrames - produced ) * secondary->nChannels * sizeof( float ) );
+      convertBuffer( info->userBuffer[1], (char *) &info->output[0], secondary->convertInfo );
+    }
+  }
+
+  RtAudioCallback callback = info->callback;
+  int result = callback( info->userBuffer[0], info->userBuffer[1], nFrames,
+                         streamTime, status, info->userData );
+
+  if ( info->userBuffer[0] ) {
+    if ( outputBuffer )
+      convertBuffer( (char *) outputBuffer, info->userBuffer[0], info->primaryConvert[0] );
+    for ( i=0; i<info->secondaries.size(); i++ ) {
+      AggregateSecondary *secondary = info->secondaries[i];
+      if ( secondary->isInput ) continue;
+
+      // Frames that do not fit are dropped and reported by the
+      // secondary callback as an underflow once it drains the FIFO.
+      convertBuffer( (char *) &info->input[0], info->userBuffer[0], secondary->convertInfo );
+      double step = getAggregateStep( info->rate.rate / secondary->rate.getRate(), secondary );
+      unsigned int space = secondary->fifo.writeAvailable();
+      if ( space > info->maxFrames ) space = info->maxFrames;
+      produced = secondary->resampler.process( &info->input[0], nFrames, &info->output[0], space, step, &used );
+      secondary->fifo.write( &info->output[0], produced );
+    }
+  }
+
+  return result;
+}
+
+// *************************************************** //
+//
+// RtApi blocking i/o definitions.
+//
+// Streams opened without a callback function exchange audio with the
+// client through single-producer, single-consumer ring buffers.  The
+// callback thread never takes a lock: it only advances the ring
+// indices and, on Linux, wakes a waiting client with a futex.
+//
+// *************************************************** //
+
+// The capacity of the blocking i/o ring buffers, in stream buffers.
+static const unsigned int BLOCKING_RING_BUFFERS = 4;
+
+// The longest time that a blocking client waits before checking the
+// stream state again, in seconds.
+static const double BLOCKING_WAIT_TIMEOUT = 0.1;
+
+struct BlockingInfo {
+  unsigned int frameBytes[2];
+  RtAudioRingBuffer<char> ring[2];
+  StreamWaiter waiter;
+
+  BlockingInfo()
+  { frameBytes[0] = 0; frameBytes[1] = 0; }
+};
+
+static int blockingCallbackHandler( void *outputBuffer, void *inputBuffer, unsigned int nFrames,
+                                    double /*streamTime*/, RtAudioStreamStatus /*status*/, void *userData )
+{
+  RtApi *object = (RtApi *) userData;
+  return object->blockingCallbackEvent( outputBuffer, inputBuffer, nFrames );
+}
+
+bool RtApi :: openBlockingStream( unsigned int channels[2], unsigned int blockFrames )
+{
+  if ( stream_.userInterleaved == false ) {
+    errorText_ = "RtApi::openStream: blocking i/o requires interleaved buffers.";
+    return FAILURE;
+  }
+
+  BlockingInfo *info = new BlockingInfo;
+  for ( int mode=0; mode<2; mode++ ) {
+    if ( channels[mode] == 0 ) continue;
+    info->frameBytes[mode] = channels[mode] * formatBytes( stream_.userFormat );
+    info->ring[mode].allocate( BLOCKING_RING_BUFFERS * std::max( blockFrames, stream_.bufferSize ),
+                               info->frameBytes[mode] );
+  }
+
+  blockingHandle_ = (void *) info;
+  return SUCCESS;
+}
+
+void RtApi :: closeBlockingStream( void )
+{
+  BlockingInfo *info = (BlockingInfo *) blockingHandle_;
+  if ( info == 0 ) return;
+
+  delete info;
+  blockingHandle_ = 0;
+}
+
+int RtApi :: blockingCallbackEvent( void *outputBuffer, void *inputBuffer, unsigned int nFrames )
+{
+  BlockingInfo *info = (BlockingInfo *) blockingHandle_;
+
+  // Output frames that the client has not written yet are silent, and
+  // input frames that do not fit are dropped.
+  if ( outputBuffer ) {
+    unsigned int n = info->ring[0].read( (char *) outputBuffer, nFrames );
+    memset( (char *) outputBuffer + n * info->frameBytes[0], 0, ( nFrames - n ) * info->frameBytes[0] );
+  }
+  if ( inputBuffer )
+    info->ring[1].write( (char *) inputBuffer, nFrames );
+
+  info->waiter.wake();
+  return 0;
+}
+
+unsigned int RtApi :: readStream( void *buffer, unsigned int nFrames, bool blocking )
+{
+  verifyStream();
+  BlockingInfo *info = (BlockingInfo *) blockingHandle_;
+  if ( info == 0 || info->frameBytes[1] == 0 ) {
+    errorText_ = "RtApi::readStream(): the stream was not opened for blocking input!";
+    error( RtAudioError::INVALID_USE );
+    return 0;
+  }
+
+  char *frames = (char *) buffer;
+  unsigned int total = 0;
+  while ( true ) {
+    int sequence = info->waiter.sequence();
+    unsigned int n = info->ring[1].read( frames, nFrames - total );
+    frames += n * info->frameBytes[1];
+    total += n;
+    if ( total == nFrames || !blocking || stream_.state != STREAM_RUNNING ) break;
+    info->waiter.wait( sequence, BLOCKING_WAIT_TIMEOUT );
+  }
+
+  return total;
+}
+
+unsigned int RtApi :: writeStream( const void *buffer, unsigned int nFrames, bool blocking )
+{
+  verifyStream();
+  BlockingInfo *info = (BlockingInfo *) blockingHandle_;
+  if ( info == 0 || info->frameBytes[0] == 0 ) {
+    errorText_ = "RtApi::writeStream(): the stream was not opened for blocking output!";
+    error( RtAudioError::INVALID_USE );
+    return 0;
+  }
+
+  const char *frames = (const char *) buffer;
+  unsigned int total = 0;
+  while ( true ) {
+    int sequence = info->waiter.sequence();
+    unsigned int n = info->ring[0].write( frames, nFrames - total );
+    frames += n * info->frameBytes[0];
+    total += n;
+    if ( total == nFrames || !blocking || stream_.state != STREAM_RUNNING ) break;
+    info->waiter.wait( sequence, BLOCKING_WAIT_TIMEOUT );
+  }
+
+  return total;
+}
+
+unsigned int RtApi :: getStreamReadAvailable( void )
+{
+  verifyStream();
+  BlockingInfo *info = (BlockingInfo *) blockingHandle_;
+  if ( info == 0 || info->frameBytes[1] == 0 ) {
+    errorText_ = "RtApi::getStreamReadAvailable(): the stream was not opened for blocking input!";
+    error( RtAudioError::INVALID_USE );
+    return 0;
+  }
+
+  return info->ring[1].readAvailable();
+}
+
+unsigned int RtApi :: getStreamWriteAvailable( void )
+{
+  verifyStream();
+  BlockingInfo *info = (BlockingInfo *) blockingHandle_;
+  if ( info == 0 || info->frameBytes[0] == 0 ) {
+    errorText_ = "RtApi::getStreamWriteAvailable(): the stream was not opened for blocking output!";
+    error( RtAudioError::INVALID_USE );
+    return 0;
+  }
+
+  return info->ring[0].writeAvailable();
+}
+
+// *************************************************** //
+//
+// RtApi block adapter definitions.
+//
+// With the RTAUDIO_FIXED_BLOCK_SIZE flag, the client callback is
+// invoked with the requested block size B, while the device callback
+// processes the negotiated buffer size P.  Input frames are collected
+// until a block is complete, and the output is preceded by B - gcd(B, P)
+// frames of silence, the least latency that always leaves P output
+// frames ready once the input available has been processed.
+//
+// *************************************************** //
+
+// A queue of user-format frames, interleaved or with one plane per
+// channel.  It is only accessed from the callback thread.
+struct BlockQueue {
+  char *buffer;
+  unsigned int capacity;  // In frames, which is also the plane size.
+  unsigned int frames;
+  unsigned int channels;
+  unsigned int sampleBytes;
+  bool interleaved;
+
+  BlockQueue()
+    :buffer(0), capacity(0), frames(0), channels(0), sampleBytes(0), interleaved(true) {}
+};
+
+// Copies frames between buffers whose planes hold the given number
+// of frames when not interleaved.
+static void copyBlockFrames( char *out, unsigned int outFrames, unsigned int outOffset,
+                             const char *in, unsigned int inFrames, unsigned int inOffset,
+                             unsigned int nFrames, const BlockQueue &queue )
+{
+  if ( queue.interleaved ) {
+    unsigned int frameBytes = queue.channels * queue.sampleBytes;
+    memmove( out + outOffset * frameBytes, in + inOffset * frameBytes, nFrames * frameBytes );
+    return;
+  }
+
+  for ( unsigned int i=0; i<queue.channels; i++ )
+    memmove( out + ( i * outFrames + outOffset ) * queue.sampleBytes,
+             in + ( i * inFrames + inOffset ) * queue.sampleBytes, nFrames * queue.sampleBytes );
+}
+
+struct BlockAdapterInfo {
+  RtAudioCallback callback;
+  void *userData;
+  unsigned int blockFrames;
+  unsigned int pending;       // Input frames not yet passed to the callback.
+  BlockQueue queue[2];
+  char *userBuffer[2];        // One block, in the user format.
+  unsigned long latency;
+
+  BlockAdapterInfo()
+    :callback(0), userData(0), blockFrames(0), pending(0), latency(0)
+  { userBuffer[0] = 0; userBuffer[1] = 0; }
+};
+
+static int blockAdapterHandler( void *outputBuffer, void *inputBuffer, unsigned int /*nFrames*/,
+                                double streamTime, RtAudioStreamStatus status, void *userData )
+{
+  RtApi *object = (RtApi *) userData;
+  return object->blockAdapterEvent( outputBuffer, inputBuffer, streamTime, status );
+}
+
+static unsigned int greatestCommonDivisor( unsigned int a, unsigned int b )
+{
+  while ( b ) {
+    unsigned int t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+bool RtApi :: openBlockAdapter( unsigned int channels[2], unsigned int blockFrames,
+                                RtAudioCallback callback, void *userData )
+{
+  BlockAdapterInfo *info = new BlockAdapterInfo;
+  info->callback = callback;
+  info->userData = userData;
+  info->blockFrames = blockFrames;
+  info->latency = blockFrames - greatestCommonDivisor( blockFrames, stream_.bufferSize );
+
+  unsigned int sampleBytes = formatBytes( stream_.userFormat );
+  for ( int mode=0; mode<2; mode++ ) {
+    if ( channels[mode] == 0 ) continue;
+    BlockQueue &queue = info->queue[mode];
+    queue.capacity = stream_.bufferSize + blockFrames;
+    queue.channels = channels[mode];
+    queue.sampleBytes = sampleBytes;
+    queue.interleaved = stream_.userInterleaved;
+    queue.buffer = (char *) calloc( queue.capacity * channels[mode], sampleBytes );
+    info->userBuffer[mode] = (char *) calloc( blockFrames * channels[mode], sampleBytes );
+    if ( queue.buffer == NULL || info->userBuffer[mode] == NULL ) {
+      blockAdapterHandle_ = (void *) info;
+      closeBlockAdapter();
+      errorText_ = "RtApi::openStream: error allocating block adapter memory.";
+      return FAILURE;
+    }
+  }
+
+  // The output starts with silence.
+  info->queue[0].frames = info->latency;
+
+  blockAdapterHandle_ = (void *) info;
+  return SUCCESS;
+}
+
+void RtApi :: closeBlockAdapter( void )
+{
+  BlockAdapterInfo *info = (BlockAdapterInfo *) blockAdapterHandle_;
+  if ( info == 0 ) return;
+
+  for ( int i=0; i<2; i++ ) {
+    if ( info->queue[i].buffer ) free( info->queue[i].buffer );
+    if ( info->userBuffer[i] ) free( info->userBuffer[i] );
+  }
+
+  delete info;
+  blockAdapterHandle_ = 0;
+}
+
+void RtApi :: reconfigureStream( unsigned int *bufferFrames, unsigned int sampleRate )
+{
+  verifyStream();
+  if ( aggregateHandle_ ) {
+    errorText_ = "RtApi::reconfigureStream(): aggregate streams cannot be reconfigured.";
+    error( RtAudioError::INVALID_USE );
+    return;
+  }
+
+  if ( bufferFrames == NULL || *bufferFrames == 0 || sampleRate == 0 ) {
+    errorText_ = "RtApi::reconfigureStream(): the buffer size and sample rate must be greater than zero.";
+    error( RtAudioError::INVALID_USE );
+    return;
+  }
+
+  // Check before stopping the stream, such that it keeps running when
+  // the API cannot reconfigure it.
+  if ( !canReconfigure() ) {
+    errorText_ = "RtApi::reconfigureStream(): reconfiguring a stream is not supported by this API!";
+    error( RtAudioError::INVALID_USE );
+    return;
+  }
+
+  bool running = ( stream_.state == STREAM_RUNNING );
+  if ( running ) abortStream();
+
+  // The block size requested for the callback, if it must be kept.
+  unsigned int blockFrames = 0;
+  if ( stream_.flags & RTAUDIO_FIXED_BLOCK_SIZE ) blockFrames = *bufferFrames;
+
+  unsigned int bufferSize = *bufferFrames;
+  if ( reconfigureDevices( sampleRate, &bufferSize ) == false ) {
+    // The stream is closed if its devices were left unconfigured.
+    if ( stream_.state == STREAM_CLOSED ) {
+      closeBlockAdapter();
+      closeBlockingStream();
+      error( RtAudioError::SYSTEM_ERROR );
+    }
+    else
+      error( RtAudioError::INVALID_USE );
+    return;
+  }
+
+  // The callback thread is parked, so the blocking i/o buffers and the
+  // block adapter can be rebuilt for the new buffer size.
+  RtAudioCallback callback = (RtAudioCallback) stream_.callbackInfo.callback;
+  void *userData = stream_.callbackInfo.userData;
+  BlockAdapterInfo *adapter = (BlockAdapterInfo *) blockAdapterHandle_;
+  if ( adapter ) {
+    callback = adapter->callback;
+    userData = adapter->userData;
+  }
+  bool blocking = ( blockingHandle_ != 0 );
+  closeBlockAdapter();
+  closeBlockingStream();
+
+  unsigned int channels[2] = { stream_.nUserChannels[0], stream_.nUserChannels[1] };
+  if ( blockFrames == stream_.bufferSize ) blockFrames = 0;
+  if ( blocking ) {
+    if ( openBlockingStream( channels, blockFrames ? blockFrames : stream_.bufferSize ) == false ) {
+      closeStream();
+      error( RtAudioError::INVALID_USE );
+      return;
+    }
+    callback = blockingCallbackHandler;
+    userData = (void *) this;
+  }
+
+  *bufferFrames = stream_.bufferSize;
+  if ( blockFrames ) {
+    if ( openBlockAdapter( channels, blockFrames, callback, userData ) == false ) {
+      closeStream();
+      closeBlockingStream();
+      error( RtAudioError::SYSTEM_ERROR );
+      return;
+    }
+    callback = blockAdapterHandler;
+    userData = (void *) this;
+    *bufferFrames = blockFrames;
+  }
+
+  stream_.callbackInfo.callback = (void *) callback;
+  stream_.callbackInfo.userData = userData;
+
+  if ( running ) startStream();
+}
+
+bool RtApi :: reconfigureDevices( unsigned int /*sampleRate*/, unsigned int * /*bufferSize*/ )
+{
+  // Should be implemented in subclasses that can reconfigure their
+  // devices in place.
+  errorText_ = "RtApi::reconfigureStream(): reconfiguring a stream is not supported by this API!";
+  return FAILURE;
+}
+
+int RtApi :: blockAdapterEvent( void *outputBuffer, void *inputBuffer, double streamTime,
+                                RtAudioStreamStatus status )
+{
+  BlockAdapterInfo *info = (BlockAdapterInfo *) blockAdapterHandle_;
+  BlockQueue &input = info->queue[1];
+  BlockQueue &output = info->queue[0];
+  unsigned int nFrames = stream_.bufferSize, block = info->blockFrames;
+  int result = 0;
+
+  if ( inputBuffer ) {
+    copyBlockFrames( input.buffer, input.capacity, input.frames,
+                     (char *) inputBuffer, nFrames, 0, nFrames, input );
+    input.frames += nFrames;
+  }
+
+  // Invoke the callback for every complete block.  Output-only streams
+  // count their frames the same way to keep the output queue filled.
+  info->pending += nFrames;
+  while ( info->pending >= block && result == 0 ) {
+    if ( input.buffer ) {
+      copyBlockFrames( info->userBuffer[1], block, 0, input.buffer, input.capacity, 0, block, input );
+      input.frames -= block;
+      copyBlockFrames( input.buffer, input.capacity, 0, input.buffer, input.capacity, block, input.frames, input );
+    }
+
+    result = info->callback( info->userBuffer[0], info->userBuffer[1], block,
+                             streamTime, status, info->userData );
+    status = 0;
+
+    if ( output.buffer ) {
+      copyBlockFrames( output.buffer, output.capacity, output.frames, info->userBuffer[0], block, 0, block, output );
+      output.frames += block;
+    }
+    info->pending -= block;
+  }
+
+  if ( outputBuffer ) {
+    unsigned int n = std::min( nFrames, output.frames );
+    copyBlockFrames( (char *) outputBuffer, nFrames, 0, output.buffer, output.capacity, 0, n, output );
+    output.frames -= n;
+    copyBlockFrames( output.buffer, output.capacity, 0, output.buffer, output.capacity, n, output.frames, output );
+
+    // Frames can only be missing after the callback stopped the stream.
+    if ( n < nFrames ) {
+      if ( output.interleaved )
+        memset( (char *) outputBuffer + n * output.channels * output.sampleBytes, 0,
+                ( nFrames - n ) * output.channels * output.sampleBytes );
+      else
+        for ( unsigned int i=0; i<output.channels; i++ )
+          memset( (char *) outputBuffer + ( i * nFrames + n ) * output.sampleBytes, 0,
+                  ( nFrames - n ) * output.sampleBytes );
+    }
+  }
+
+  // Once the callback stops the stream, the remaining blocks are
+  // discarded and the adapter starts over when the stream restarts.
+  if ( result != 0 ) {
+    info->pending = 0;
+    input.frames = 0;
+    if ( output.buffer ) {
+      memset( output.buffer, 0, output.capacity * output.channels * output.sampleBytes );
+      output.frames = info->latency;
+    }
+  }
+
+  return result;
+}
+
+long RtApi :: getStreamLatency( void )
+{
+  return getStreamOutputLatency() + getStreamInputLatency();
+}
+
+long RtApi :: getStreamOutputLatency( void )
+{
+  verifyStream();
+
+  long latency = 0;
+  if ( stream_.mode == OUTPUT || stream_.mode == DUPLEX )
+    latency = stream_.latency[0];
+
+  // Add the elastic buffers of an aggregate stream, and the secondary
+  // devices if the primary device does not handle this direction.
+  AggregateInfo *info = (AggregateInfo *) aggregateHandle_;
+  if ( info ) latency += info->addedLatency[0] + info->deviceLatency[0];
+
+  // The adapter between the device and callback block sizes delays
+  // the output, unless the stream is input-only.
+  BlockAdapterInfo *adapter = (BlockAdapterInfo *) blockAdapterHandle_;
+  if ( adapter && adapter->queue[0].buffer ) latency += adapter->latency;
+
+  return latency;
 }
 
-void RtApi :: closeStream( void )
+long RtApi :: getStreamInputLatency( void )
 {
-  // MUST be implemented in subclasses!
-  return;
+  verifyStream();
+
+  long latency = 0;
+  if ( stream_.mode == INPUT || stream_.mode == DUPLEX )
+    latency = stream_.latency[1];
+
+  AggregateInfo *info = (AggregateInfo *) aggregateHandle_;
+  if ( info ) latency += info->addedLatency[1] + info->deviceLatency[1];
+
+  BlockAdapterInfo *adapter = (BlockAdapterInfo *) blockAdapterHandle_;
+  if ( adapter && adapter->queue[0].buffer == 0 ) latency += adapter->latency;
+
+  return latency;
 }
 
-bool RtApi :: probeDeviceOpen( unsigned int /*device*/, StreamMode /*mode*/, unsigned int /*channels*/,
-                               unsigned int /*firstChannel*/, unsigned int /*sampleRate*/,
-                               RtAudioFormat /*format*/, unsigned int * /*bufferSize*/,
-                               RtAudio::StreamOptions * /*options*/ )
+long RtApi :: getStreamAddedLatency( void )
 {
-  // MUST be implemented in subclasses!
-  return FAILURE;
+  verifyStream();
+
+  long addedLatency = 0;
+  AggregateInfo *info = (AggregateInfo *) aggregateHandle_;
+  if ( info ) addedLatency = info->addedLatency[0] + info->addedLatency[1];
+  BlockAdapterInfo *adapter = (BlockAdapterInfo *) blockAdapterHandle_;
+  if ( adapter ) addedLatency += adapter->latency;
+
+  return addedLatency;
 }
 
-void RtApi :: tickStreamTime( void )
+RtAudio::StreamStats RtApi :: getStreamStats( void )
 {
-  // Subclasses that do not provide their own implementation of
-  // getStreamTime should call this function once per buffer I/O to
-  // provide basic stream time support.
+  verifyStream();
 
-  stream_.streamTime += ( stream_.bufferSize * 1.0 / stream_.sampleRate );
+  RtAudio::StreamStats stats = stream_.stats;
+  stats.nBuffers = getFilledBuffers();
+  return stats;
+}
 
-#if defined( HAVE_GETTIMEOFDAY )
-  gettimeofday( &stream_.lastTickTimestamp, NULL );
-#endif
+unsigned int RtApi :: getFilledBuffers( void ) const
+{
+  return stream_.adaptive.maximum ? stream_.adaptive.current : stream_.nBuffers;
 }
 
-long RtApi :: getStreamLatency( void )
+// The number of xruns within ADAPTIVE_XRUN_WINDOW seconds that raise
+// the buffering of a stream, and the number of seconds without xruns
+// after which it is lowered again.
+static const unsigned int ADAPTIVE_XRUN_COUNT = 2;
+static const double ADAPTIVE_XRUN_WINDOW = 10.0;
+static const double ADAPTIVE_QUIET_INTERVAL = 30.0;
+
+int RtApi :: updateStreamStats( RtAudioStreamStatus status )
 {
-  verifyStream();
+  stream_.stats.callbacks++;
+  if ( status & RTAUDIO_INPUT_OVERFLOW ) stream_.stats.inputOverflows++;
+  if ( status & RTAUDIO_OUTPUT_UNDERFLOW ) stream_.stats.outputUnderflows++;
 
-  long totalLatency = 0;
-  if ( stream_.mode == OUTPUT || stream_.mode == DUPLEX )
-    totalLatency = stream_.latency[0];
-  if ( stream_.mode == INPUT || stream_.mode == DUPLEX )
-    totalLatency += stream_.latency[1];
+  AdaptiveBuffering &adaptive = stream_.adaptive;
+  if ( adaptive.maximum == 0 ) return 0;
+
+  double now = getMonotonicTime();
+  if ( status ) {
+    if ( adaptive.xruns == 0 || now - adaptive.windowStart > ADAPTIVE_XRUN_WINDOW ) {
+      adaptive.windowStart = now;
+      adaptive.xruns = 0;
+    }
+    adaptive.lastChange = now;
+    if ( ++adaptive.xruns < ADAPTIVE_XRUN_COUNT || adaptive.current == adaptive.maximum ) return 0;
+    adaptive.xruns = 0;
+    adaptive.current++;
+    stream_.stats.bufferIncreases++;
+    return 1;
+  }
 
-  return totalLatency;
+  if ( adaptive.lastChange == 0.0 ) adaptive.lastChange = now;
+  if ( adaptive.current == adaptive.minimum || now - adaptive.lastChange < ADAPTIVE_QUIET_INTERVAL ) return 0;
+  adaptive.lastChange = now;
+  adaptive.current--;
+  stream_.stats.bufferDecreases++;
+  return -1;
 }
 
 double RtApi :: getStreamTime( void )
@@ -440,6 +2187,256 @@ unsigned int RtApi :: getStreamSampleRate( void )
  return stream_.sampleRate;
 }
 
+double RtApi :: getStreamStartOffset( void )
+{
+  verifyStream();
+
+  return stream_.startOffset;
+}
+
+
+// *************************************************** //
+//
+// RtAudioEngine definitions.
+//
+// *************************************************** //
+
+#if defined(__LINUX_ALSA__) || defined(__LINUX_PULSE__) || defined(__UNIX_JACK__) || defined(__LINUX_OSS__) || defined(__MACOSX_CORE__)
+
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+// Streams that are stopped are not polled, so the engine threads
+// check them again after this many milliseconds.
+static const int ENGINE_IDLE_TIMEOUT = 10;
+
+struct EngineHandle;
+
+// A structure to hold the information related to one engine thread.
+struct EngineThread {
+  RtAudioEngine *engine;
+  EngineHandle *handle;
+  unsigned int index;
+  pthread_t thread;
+  int wakeFds[2]; // A pipe used to interrupt the thread's poll().
+
+  EngineThread()
+    :engine(0), handle(0), index(0) { wakeFds[0] = -1; wakeFds[1] = -1; }
+};
+
+struct EngineHandle {
+  std::vector<EngineThread> threads;
+  bool isRunning;
+  bool doRealtime;
+  int priority;
+
+  EngineHandle()
+    :isRunning(false), doRealtime(false), priority(0) {}
+};
+
+static void *engineThreadHandler( void *ptr )
+{
+  EngineThread *info = (EngineThread *) ptr;
+
+#ifdef SCHED_RR // Undefined with some OSes (eg: NetBSD 1.6.x with GNU Pthread)
+  if ( info->handle->doRealtime ) {
+    pthread_t tID = pthread_self();	 // ID of this thread
+    sched_param prio = { info->handle->priority }; // scheduling priority of thread
+    pthread_setschedparam( tID, SCHED_RR, &prio );
+  }
+#endif
+
+  info->engine->processThread( info->index );
+
+  pthread_exit( NULL );
+}
+
+#endif
+
+RtAudioEngine :: RtAudioEngine()
+  :nThreads_(0), isRunning_(false), engineHandle_(0)
+{
+}
+
+RtAudioEngine :: ~RtAudioEngine()
+{
+  if ( isRunning_ ) stop();
+}
+
+void RtAudioEngine :: addStream( RtAudio *audio )
+{
+  if ( isRunning_ )
+    throw( RtAudioError( "RtAudioEngine::addStream: streams cannot be added while the engine is running!", RtAudioError::INVALID_USE ) );
+
+  if ( audio == NULL || !audio->isStreamOpen() )
+    throw( RtAudioError( "RtAudioEngine::addStream: the stream is not open!", RtAudioError::INVALID_USE ) );
+
+  if ( !audio->rtapi_->isStreamManual() )
+    throw( RtAudioError( "RtAudioEngine::addStream: the stream was not opened with the RTAUDIO_MANUAL_PUMP flag!", RtAudioError::INVALID_USE ) );
+
+  if ( audio->rtapi_->getStreamPollDescriptors( NULL, 0 ) == 0 )
+    throw( RtAudioError( "RtAudioEngine::addStream: the stream API does not support polling!", RtAudioError::INVALID_USE ) );
+
+  if ( std::find( streams_.begin(), streams_.end(), audio ) == streams_.end() )
+    streams_.push_back( audio );
+}
+
+void RtAudioEngine :: removeStream( RtAudio *audio )
+{
+  if ( isRunning_ )
+    throw( RtAudioError( "RtAudioEngine::removeStream: streams cannot be removed while the engine is running!", RtAudioError::INVALID_USE ) );
+
+  std::vector<RtAudio *>::iterator it = std::find( streams_.begin(), streams_.end(), audio );
+  if ( it != streams_.end() ) streams_.erase( it );
+}
+
+void RtAudioEngine :: start( unsigned int nThreads, bool realtime, int priority )
+{
+  if ( isRunning_ )
+    throw( RtAudioError( "RtAudioEngine::start: the engine is already running!", RtAudioError::INVALID_USE ) );
+
+#if defined(__LINUX_ALSA__) || defined(__LINUX_PULSE__) || defined(__UNIX_JACK__) || defined(__LINUX_OSS__) || defined(__MACOSX_CORE__)
+  if ( nThreads < 1 ) nThreads = 1;
+
+  EngineHandle *handle = new EngineHandle;
+  handle->isRunning = true;
+#ifdef SCHED_RR
+  if ( realtime ) {
+    int min = sched_get_priority_min( SCHED_RR );
+    int max = sched_get_priority_max( SCHED_RR );
+    if ( priority < min ) priority = min;
+    else if ( priority > max ) priority = max;
+    handle->doRealtime = true;
+    handle->priority = priority;
+  }
+#endif
+
+  // The thread structures must not move once the threads are running.
+  handle->threads.resize( nThreads );
+  engineHandle_ = (void *) handle;
+  nThreads_ = nThreads;
+  isRunning_ = true;
+
+  std::string errorText;
+  RtAudioError::Type errorType = RtAudioError::THREAD_ERROR;
+  for ( unsigned int i=0; i<nThreads; i++ ) {
+    EngineThread &info = handle->threads[i];
+    info.engine = this;
+    info.handle = handle;
+    info.index = i;
+    if ( pipe( info.wakeFds ) ) {
+      info.wakeFds[0] = -1;
+      info.wakeFds[1] = -1;
+      errorText = "RtAudioEngine::start: error creating wakeup pipe.";
+      errorType = RtAudioError::SYSTEM_ERROR;
+      break;
+    }
+    if ( pthread_create( &info.thread, NULL, engineThreadHandler, &info ) ) {
+      close( info.wakeFds[0] );
+      close( info.wakeFds[1] );
+      info.wakeFds[0] = -1;
+      info.wakeFds[1] = -1;
+      errorText = "RtAudioEngine::start: error creating engine thread.";
+      break;
+    }
+  }
+
+  if ( errorText.empty() ) return;
+
+  // Stop the threads that were created before the failure.
+  stop();
+  throw( RtAudioError( errorText, errorType ) );
+#else
+  (void) nThreads; (void) realtime; (void) priority;
+  throw( RtAudioError( "RtAudioEngine::start: engine threads are not supported on this platform!", RtAudioError::INVALID_USE ) );
+#endif
+}
+
+void RtAudioEngine :: stop( void )
+{
+  if ( !isRunning_ ) return;
+
+#if defined(__LINUX_ALSA__) || defined(__LINUX_PULSE__) || defined(__UNIX_JACK__) || defined(__LINUX_OSS__) || defined(__MACOSX_CORE__)
+  EngineHandle *handle = (EngineHandle *) engineHandle_;
+  handle->isRunning = false;
+  for ( unsigned int i=0; i<handle->threads.size(); i++ ) {
+    EngineThread &info = handle->threads[i];
+    if ( info.wakeFds[1] == -1 ) continue; // thread was never created
+    char wake = 1;
+    if ( write( info.wakeFds[1], &wake, 1 ) != 1 ) {
+      // The pipe is never read, so this cannot fail unless it is full,
+      // in which case the thread will wake anyway.
+    }
+    pthread_join( info.thread, NULL );
+    close( info.wakeFds[0] );
+    close( info.wakeFds[1] );
+  }
+  delete handle;
+#endif
+
+  engineHandle_ = 0;
+  nThreads_ = 0;
+  isRunning_ = false;
+}
+
+void RtAudioEngine :: processThread( unsigned int thread )
+{
+#if defined(__LINUX_ALSA__) || defined(__LINUX_PULSE__) || defined(__UNIX_JACK__) || defined(__LINUX_OSS__) || defined(__MACOSX_CORE__)
+  EngineHandle *handle = (EngineHandle *) engineHandle_;
+  EngineThread &info = handle->threads[thread];
+
+  // The streams serviced by this thread, in the order they were added.
+  std::vector<RtApi *> apis;
+  unsigned int nDescriptors = 1;
+  for ( unsigned int i=thread; i<streams_.size(); i+=nThreads_ ) {
+    apis.push_back( streams_[i]->rtapi_ );
+    nDescriptors += streams_[i]->rtapi_->getStreamPollDescriptors( NULL, 0 );
+  }
+
+  std::vector<struct pollfd> pfds;
+  pfds.reserve( nDescriptors );
+  while ( handle->isRunning ) {
+
+    // Service every stream that can process a buffer without blocking.
+    bool allRunning = true;
+    for ( unsigned int i=0; i<apis.size(); i++ ) {
+      if ( !apis[i]->isStreamRunning() ) {
+        allRunning = false;
+        continue;
+      }
+      if ( apis[i]->isStreamReady() ) {
+        try {
+          apis[i]->tickStream();
+        }
+        catch ( RtAudioError &e ) {
+          e.printMessage();
+        }
+      }
+    }
+
+    // Wait until one of the running devices needs service.
+    pfds.resize( 1 );
+    pfds[0].fd = info.wakeFds[0];
+    pfds[0].events = POLLIN;
+    pfds[0].revents = 0;
+    for ( unsigned int i=0; i<apis.size(); i++ ) {
+      if ( !apis[i]->isStreamRunning() ) continue;
+      unsigned int offset = pfds.size();
+      unsigned int count = apis[i]->getStreamPollDescriptors( NULL, 0 );
+      pfds.resize( offset + count );
+      count = apis[i]->getStreamPollDescriptors( &pfds[offset], count );
+      pfds.resize( offset + count );
+    }
+
+    poll( &pfds[0], pfds.size(), allRunning ? -1 : ENGINE_IDLE_TIMEOUT );
+  }
+#else
+  (void) thread;
+#endif
+}
+
+#endif // !__RTAUDIO_PLUGIN_ONLY__
 
 // *************************************************** //
 //
@@ -1633,6 +3630,7 @@ bool RtApiCore :: callbackEvent( AudioDeviceID deviceId,
       handle->xrun[1] = false;
     }
 
+    updateStreamStats( status );
     int cbReturnValue = callback( stream_.userBuffer[0], stream_.userBuffer[1],
                                   stream_.bufferSize, streamTime, status, info->userData );
     if ( cbReturnValue == 2 ) {
@@ -1894,7 +3892,7 @@ const char* RtApiCore :: getErrorCode( OSStatus code )
   //******************** End of __MACOSX_CORE__ *********************//
 #endif
 
-#if defined(__UNIX_JACK__)
+#if defined(__UNIX_JACK__) && ( !defined(__RTAUDIO_PLUGINS__) || defined(__RTAUDIO_PLUGIN_JACK__) )
 
 // JACK is a low-latency audio server, originally written for the
 // GNU/Linux operating system and now also ported to OS-X. It can
@@ -1944,12 +3942,35 @@ struct JackHandle {
     :client(0), drainCounter(0), internalDrain(false) { ports[0] = 0; ports[1] = 0; xrun[0] = false; xrun[1] = false; }
 };
 
+// A structure to hold the client used for device queries by the
+// instances sharing an API context.
+struct JackInfoClient {
+  jack_client_t *client;
+  bool isShutdown;
+
+  JackInfoClient()
+    :client(0), isShutdown(false) {}
+};
+
+static void jackInfoShutdown( void *infoPointer )
+{
+  JackInfoClient *info = (JackInfoClient *) infoPointer;
+  info->isShutdown = true;
+}
+
+static void jackCloseInfoClient( void *infoPointer )
+{
+  JackInfoClient *info = (JackInfoClient *) infoPointer;
+  if ( info->client ) jack_client_close( info->client );
+  delete info;
+}
+
 #if !defined(__RTAUDIO_DEBUG__)
 static void jackSilentError( const char * ) {};
 #endif
 
 RtApiJack :: RtApiJack()
-    :shouldAutoconnect_(true) {
+    :notifyClient_(0), shouldAutoconnect_(true) {
   // Nothing to do here.
 #if !defined(__RTAUDIO_DEBUG__)
   // Turn off Jack's internal error reporting.
@@ -1960,38 +3981,156 @@ RtApiJack :: RtApiJack()
 RtApiJack :: ~RtApiJack()
 {
   if ( stream_.state != STREAM_CLOSED ) closeStream();
+  stopDeviceNotification();
 }
 
-unsigned int RtApiJack :: getDeviceCount( void )
+static void jackClientRegistration( const char *name, int, void *infoPointer )
 {
-  // See if we can become a jack client.
-  jack_options_t options = (jack_options_t) ( JackNoStartServer ); //JackNullOption;
+  // The clients opened by the device queries and for the
+  // notifications are no devices, and Jack may append a suffix to
+  // their names.  Reporting them would make a callback which lists
+  // the devices notify itself again.
+  static const char *ownClients[] = { "RtApiJackInfo", "RtApiJackCount", "RtApiJackNotify" };
+  for ( unsigned int i=0; i<sizeof( ownClients ) / sizeof( ownClients[0] ); i++ )
+    if ( strncmp( name, ownClients[i], strlen( ownClients[i] ) ) == 0 ) return;
+
+  ( (RtApiJack *) infoPointer )->deviceEvent();
+}
+
+// Our own info and notification clients register no ports, so every
+// port registration is reported.
+static void jackPortRegistration( jack_port_id_t, int, void *infoPointer )
+{
+  ( (RtApiJack *) infoPointer )->deviceEvent();
+}
+
+static void jackNotifyShutdown( void *infoPointer )
+{
+  ( (RtApiJack *) infoPointer )->deviceEvent();
+}
+
+bool RtApiJack :: setDeviceCallback( RtAudioDeviceCallback callback, void *userData )
+{
+  stopDeviceNotification();
+  deviceCallback_ = callback;
+  deviceUserData_ = userData;
+  if ( callback == 0 ) return true;
+
+  // The devices are the clients with ports, so a client of our own
+  // receives the registration callbacks on the Jack notification
+  // thread.
+  jack_options_t options = (jack_options_t) ( JackNoStartServer );
   jack_status_t *status = NULL;
-  jack_client_t *client = jack_client_open( "RtApiJackCount", options, status );
-  if ( client == 0 ) return 0;
+  jack_client_t *client = jack_client_open( "RtApiJackNotify", options, status );
+  if ( client == 0 ) {
+    deviceCallback_ = 0;
+    errorText_ = "RtApiJack::setDeviceCallback: Jack server not found or connection error!";
+    error( RtAudioError::WARNING );
+    return false;
+  }
 
-  const char **ports;
-  std::string port, previousPort;
-  unsigned int nChannels = 0, nDevices = 0;
-  ports = jack_get_ports( client, NULL, NULL, 0 );
-  if ( ports ) {
-    // Parse the port names up to the first colon (:).
-    size_t iColon = 0;
-    do {
-      port = (char *) ports[ nChannels ];
-      iColon = port.find(":");
-      if ( iColon != std::string::npos ) {
-        port = port.substr( 0, iColon + 1 );
-        if ( port != previousPort ) {
-          nDevices++;
-          previousPort = port;
-        }
-      }
-    } while ( ports[++nChannels] );
-    free( ports );
+  jack_set_client_registration_callback( client, jackClientRegistration, (void *) this );
+  jack_set_port_registration_callback( client, jackPortRegistration, (void *) this );
+  jack_on_shutdown( client, jackNotifyShutdown, (void *) this );
+  if ( jack_activate( client ) ) {
+    jack_client_close( client );
+    deviceCallback_ = 0;
+    errorText_ = "RtApiJack::setDeviceCallback: unable to activate the notification client!";
+    error( RtAudioError::WARNING );
+    return false;
   }
 
+  notifyClient_ = (void *) client;
+  return true;
+}
+
+void RtApiJack :: stopDeviceNotification( void )
+{
+  if ( notifyClient_ == 0 ) return;
+  jack_client_t *client = (jack_client_t *) notifyClient_;
+  jack_deactivate( client );
   jack_client_close( client );
+  notifyClient_ = 0;
+}
+
+void RtApiJack :: deviceEvent( void )
+{
+  if ( deviceCallback_ ) deviceCallback_( deviceUserData_ );
+}
+
+void *RtApiJack :: openInfoClient( const char *name )
+{
+  jack_options_t options = (jack_options_t) ( JackNoStartServer ); //JackNullOption;
+  jack_status_t *status = NULL;
+
+  // A single instance opens a temporary client for each query.
+  if ( !isContextShared() ) return jack_client_open( name, options, status );
+
+  // Instances created by RtAudio::createStreamHandle() share one
+  // client, which stays open until the last of them is destroyed.
+  MUTEX_LOCK( &context_->mutex );
+  JackInfoClient *info = (JackInfoClient *) context_->apiHandle;
+  if ( info && info->isShutdown ) {
+    jackCloseInfoClient( info );
+    context_->apiHandle = 0;
+    info = 0;
+  }
+  if ( info == 0 ) {
+    jack_client_t *client = jack_client_open( "RtApiJackInfo", options, status );
+    if ( client ) {
+      info = new JackInfoClient;
+      info->client = client;
+      jack_on_shutdown( client, jackInfoShutdown, (void *) info );
+      context_->apiHandle = (void *) info;
+      context_->closeApiHandle = jackCloseInfoClient;
+    }
+  }
+  jack_client_t *client = info ? info->client : 0;
+  MUTEX_UNLOCK( &context_->mutex );
+
+  return client;
+}
+
+void RtApiJack :: closeInfoClient( void *client )
+{
+  MUTEX_LOCK( &context_->mutex );
+  JackInfoClient *info = (JackInfoClient *) context_->apiHandle;
+  bool isShared = ( info && info->client == client );
+  MUTEX_UNLOCK( &context_->mutex );
+
+  if ( !isShared ) jack_client_close( (jack_client_t *) client );
+}
+
+// Lists the devices, which are the distinct port name prefixes up to
+// the first colon (:), in the order of their first port.  All the
+// device queries use this list, such that they agree on the indices.
+static std::vector<std::string> getJackDeviceNames( jack_client_t *client )
+{
+  std::vector<std::string> names;
+  const char **ports = jack_get_ports( client, NULL, NULL, 0 );
+  if ( ports == 0 ) return names;
+
+  std::string port;
+  for ( unsigned int i=0; ports[i]; i++ ) {
+    port = ports[i];
+    size_t iColon = port.find(":");
+    if ( iColon == std::string::npos ) continue;
+    port = port.substr( 0, iColon );
+    if ( std::find( names.begin(), names.end(), port ) == names.end() )
+      names.push_back( port );
+  }
+  free( ports );
+  return names;
+}
+
+unsigned int RtApiJack :: getDeviceCount( void )
+{
+  // See if we can become a jack client.
+  jack_client_t *client = (jack_client_t *) openInfoClient( "RtApiJackCount" );
+  if ( client == 0 ) return 0;
+
+  unsigned int nDevices = getJackDeviceNames( client ).size();
+  closeInfoClient( client );
   return nDevices;
 }
 
@@ -2000,9 +4139,7 @@ RtAudio::DeviceInfo RtApiJack :: getDeviceInfo( unsigned int device )
   RtAudio::DeviceInfo info;
   info.probed = false;
 
-  jack_options_t options = (jack_options_t) ( JackNoStartServer ); //JackNullOption
-  jack_status_t *status = NULL;
-  jack_client_t *client = jack_client_open( "RtApiJackInfo", options, status );
+  jack_client_t *client = (jack_client_t *) openInfoClient( "RtApiJackInfo" );
   if ( client == 0 ) {
     errorText_ = "RtApiJack::getDeviceInfo: Jack server not found or connection error!";
     error( RtAudioError::WARNING );
@@ -2010,29 +4147,11 @@ RtAudio::DeviceInfo RtApiJack :: getDeviceInfo( unsigned int device )
   }
 
   const char **ports;
-  std::string port, previousPort;
-  unsigned int nPorts = 0, nDevices = 0;
-  ports = jack_get_ports( client, NULL, NULL, 0 );
-  if ( ports ) {
-    // Parse the port names up to the first colon (:).
-    size_t iColon = 0;
-    do {
-      port = (char *) ports[ nPorts ];
-      iColon = port.find(":");
-      if ( iColon != std::string::npos ) {
-        port = port.substr( 0, iColon );
-        if ( port != previousPort ) {
-          if ( nDevices == device ) info.name = port;
-          nDevices++;
-          previousPort = port;
-        }
-      }
-    } while ( ports[++nPorts] );
-    free( ports );
-  }
+  std::vector<std::string> names = getJackDeviceNames( client );
+  if ( device < names.size() ) info.name = info.identifier = names[device];
 
-  if ( device >= nDevices ) {
-    jack_client_close( client );
+  if ( device >= names.size() ) {
+    closeInfoClient( client );
     errorText_ = "RtApiJack::getDeviceInfo: device ID is invalid!";
     error( RtAudioError::INVALID_USE );
     return info;
@@ -2064,7 +4183,7 @@ RtAudio::DeviceInfo RtApiJack :: getDeviceInfo( unsigned int device )
   }
 
   if ( info.outputChannels == 0 && info.inputChannels == 0 ) {
-    jack_client_close(client);
+    closeInfoClient( client );
     errorText_ = "RtApiJack::getDeviceInfo: error determining Jack input/output channels!";
     error( RtAudioError::WARNING );
     return info;
@@ -2083,11 +4202,74 @@ RtAudio::DeviceInfo RtApiJack :: getDeviceInfo( unsigned int device )
   if ( device == 0 && info.inputChannels > 0 )
     info.isDefaultInput = true;
 
-  jack_client_close(client);
+  closeInfoClient( client );
   info.probed = true;
   return info;
 }
 
+std::vector<RtAudio::DeviceInfo> RtApiJack :: getDevices( bool /*probeCapabilities*/ )
+{
+  std::vector<RtAudio::DeviceInfo> devices;
+  jack_client_t *client = (jack_client_t *) openInfoClient( "RtApiJackInfo" );
+  if ( client == 0 ) {
+    errorText_ = "RtApiJack::getDevices: Jack server not found or connection error!";
+    error( RtAudioError::WARNING );
+    return devices;
+  }
+
+  // The devices are listed as for getDeviceInfo(), and their channels
+  // are counted from a single list of ports per direction.  Jack
+  // "input ports" equal RtAudio output channels.
+  std::vector<std::string> names = getJackDeviceNames( client );
+  for ( unsigned int k=0; k<names.size(); k++ ) {
+    devices.push_back( RtAudio::DeviceInfo() );
+    devices[k].name = devices[k].identifier = names[k];
+  }
+
+  const char **ports;
+  std::string port;
+  for ( int i=1; i<3; i++ ) {
+    ports = jack_get_ports( client, NULL, NULL, ( i == 1 ) ? JackPortIsInput : JackPortIsOutput );
+    if ( ports == 0 ) continue;
+    for ( unsigned int j=0; ports[j]; j++ ) {
+      port = ports[j];
+      size_t iColon = port.find(":");
+      if ( iColon == std::string::npos ) continue;
+      port = port.substr( 0, iColon );
+      unsigned int k = std::find( names.begin(), names.end(), port ) - names.begin();
+      if ( k == names.size() ) continue;
+      if ( i == 1 ) devices[k].outputChannels++;
+      else devices[k].inputChannels++;
+    }
+    free( ports );
+  }
+
+  unsigned int sampleRate = jack_get_sample_rate( client );
+  closeInfoClient( client );
+
+  for ( unsigned int k=0; k<devices.size(); k++ ) {
+    RtAudio::DeviceInfo &info = devices[k];
+    if ( info.outputChannels == 0 && info.inputChannels == 0 ) {
+      errorText_ = "RtApiJack::getDevices: error determining Jack input/output channels!";
+      error( RtAudioError::WARNING );
+      continue;
+    }
+
+    info.preferredSampleRate = sampleRate;
+    info.sampleRates.push_back( sampleRate );
+    if ( info.outputChannels > 0 && info.inputChannels > 0 )
+      info.duplexChannels = (info.outputChannels > info.inputChannels) ? info.inputChannels : info.outputChannels;
+    info.nativeFormats = RTAUDIO_FLOAT32;
+    if ( k == 0 && info.outputChannels > 0 )
+      info.isDefaultOutput = true;
+    if ( k == 0 && info.inputChannels > 0 )
+      info.isDefaultInput = true;
+    info.probed = true;
+  }
+
+  return devices;
+}
+
 static int jackCallbackHandler( jack_nframes_t nframes, void *infoPointer )
 {
   CallbackInfo *info = (CallbackInfo *) infoPointer;
@@ -2166,28 +4348,11 @@ bool RtApiJack :: probeDeviceOpen( unsigned int device, StreamMode mode, unsigne
   }
 
   const char **ports;
-  std::string port, previousPort, deviceName;
-  unsigned int nPorts = 0, nDevices = 0;
-  ports = jack_get_ports( client, NULL, NULL, 0 );
-  if ( ports ) {
-    // Parse the port names up to the first colon (:).
-    size_t iColon = 0;
-    do {
-      port = (char *) ports[ nPorts ];
-      iColon = port.find(":");
-      if ( iColon != std::string::npos ) {
-        port = port.substr( 0, iColon );
-        if ( port != previousPort ) {
-          if ( nDevices == device ) deviceName = port;
-          nDevices++;
-          previousPort = port;
-        }
-      }
-    } while ( ports[++nPorts] );
-    free( ports );
-  }
+  std::string deviceName;
+  std::vector<std::string> names = getJackDeviceNames( client );
+  if ( device < names.size() ) deviceName = names[device];
 
-  if ( device >= nDevices ) {
+  if ( device >= names.size() ) {
     errorText_ = "RtApiJack::probeDeviceOpen: device ID is invalid!";
     return FAILURE;
   }
@@ -2599,6 +4764,7 @@ bool RtApiJack :: callbackEvent( unsigned long nframes )
       status |= RTAUDIO_INPUT_OVERFLOW;
       handle->xrun[1] = false;
     }
+    updateStreamStats( status );
     int cbReturnValue = callback( stream_.userBuffer[0], stream_.userBuffer[1],
                                   stream_.bufferSize, streamTime, status, info->userData );
     if ( cbReturnValue == 2 ) {
@@ -2670,6 +4836,11 @@ bool RtApiJack :: callbackEvent( unsigned long nframes )
   RtApi::tickStreamTime();
   return SUCCESS;
 }
+#if defined(__RTAUDIO_PLUGIN_JACK__)
+// The entry point of the JACK plugin (see createPluginApi()).
+extern "C" RTAUDIO_DLL_PUBLIC RtApi *rtaudio_create_api( void ) { return new RtApiJack(); }
+#endif
+
   //******************** End of __UNIX_JACK__ *********************//
 #endif
 
@@ -3443,6 +5614,7 @@ bool RtApiAsio :: callbackEvent( long bufferIndex )
       status |= RTAUDIO_INPUT_OVERFLOW;
       asioXRun = false;
     }
+    updateStreamStats( status );
     int cbReturnValue = callback( stream_.userBuffer[0], stream_.userBuffer[1],
                                      stream_.bufferSize, streamTime, status, info->userData );
     if ( cbReturnValue == 2 ) {
@@ -4891,6 +7063,8 @@ void RtApiWasapi::wasapiThread()
 
       // if callback has not requested the stream to stop
       if ( callbackPulled && !callbackStopped ) {
+        updateStreamStats( captureFlags & AUDCLNT_BUFFERFLAGS_DATA_DISCONTINUITY ? RTAUDIO_INPUT_OVERFLOW : 0 );
+
         // Execute user callback method
         callbackResult = callback( stream_.userBuffer[OUTPUT],
                                    stream_.userBuffer[INPUT],
@@ -6207,6 +8381,7 @@ void RtApiDs :: callbackEvent()
       status |= RTAUDIO_INPUT_OVERFLOW;
       handle->xrun[1] = false;
     }
+    updateStreamStats( status );
     int cbReturnValue = callback( stream_.userBuffer[0], stream_.userBuffer[1],
                                   stream_.bufferSize, streamTime, status, info->userData );
     if ( cbReturnValue == 2 ) {
@@ -6732,42 +8907,172 @@ static const char* getErrorString( int code )
 #endif
 
 
-#if defined(__LINUX_ALSA__)
+#if defined(__LINUX_ALSA__) && ( !defined(__RTAUDIO_PLUGINS__) || defined(__RTAUDIO_PLUGIN_ALSA__) )
 
 #include <alsa/asoundlib.h>
 #include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/utsname.h>
+#include <cstdio>
+#include <fstream>
 
   // A structure to hold various information related to the ALSA API
   // implementation.
 struct AlsaHandle {
   snd_pcm_t *handles[2];
   bool synchronized;
+  bool grouped;     // Linked to the devices of other streams by startStreamGroup().
   bool xrun[2];
+  snd_pcm_uframes_t availMin; // The free output frames that wake the callback thread.
   pthread_cond_t runnable_cv;
   bool runnable;
+  bool parked;      // The callback thread waits for the stream to start.
+  unsigned int pending; // Periods left to process back-to-back in catch-up mode.
+  bool canPause[2];
+  bool paused[2];   // Paused by a warm stop.
+  StreamWaiter waiter; // Wakes the callback thread after a warm stop.
 
   AlsaHandle()
-    :synchronized(false), runnable(false) { xrun[0] = false; xrun[1] = false; }
+    :synchronized(false), grouped(false), availMin(0), runnable(false), parked(false), pending(0)
+  { xrun[0] = false; xrun[1] = false; canPause[0] = false; canPause[1] = false; paused[0] = false; paused[1] = false; }
 };
 
 static void *alsaCallbackHandler( void * ptr );
 
 RtApiAlsa :: RtApiAlsa()
+  : inotifyFd_( -1 ), isEnumerated_( false ), notifyFd_( -1 ), isNotifying_( false )
 {
-  // Nothing to do here.
+  // Cards that are added or removed create or delete their nodes in
+  // /dev/snd, which invalidates the device enumeration.  Without a
+  // watch, the devices are enumerated again on every query.
+  inotifyFd_ = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+  if ( inotifyFd_ >= 0 &&
+       inotify_add_watch( inotifyFd_, "/dev/snd", IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO ) < 0 ) {
+    close( inotifyFd_ );
+    inotifyFd_ = -1;
+  }
 }
 
 RtApiAlsa :: ~RtApiAlsa()
 {
   if ( stream_.state != STREAM_CLOSED ) closeStream();
+  stopDeviceNotification();
+  if ( inotifyFd_ >= 0 ) close( inotifyFd_ );
 }
 
-unsigned int RtApiAlsa :: getDeviceCount( void )
+// The time for which /dev/snd must be quiet before a change of the
+// cards is reported, in milliseconds.
+static const int ALSA_NOTIFY_DELAY = 200;
+
+static void *alsaNotifyHandler( void *ptr )
+{
+  RtApiAlsa *object = (RtApiAlsa *) ptr;
+  object->deviceEvent();
+  pthread_exit( NULL );
+}
+
+bool RtApiAlsa :: setDeviceCallback( RtAudioDeviceCallback callback, void *userData )
+{
+  stopDeviceNotification();
+  deviceCallback_ = callback;
+  deviceUserData_ = userData;
+  if ( callback == 0 ) return true;
+
+  // The notifications have a watch of their own, such that they do
+  // not consume the events that invalidate the device enumeration.
+  notifyFd_ = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+  if ( notifyFd_ < 0 ||
+       inotify_add_watch( notifyFd_, "/dev/snd", IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO ) < 0 ) {
+    errorText_ = "RtApiAlsa::setDeviceCallback: error watching /dev/snd.";
+    goto error;
+  }
+
+  if ( pipe( notifyPipe_ ) ) {
+    errorText_ = "RtApiAlsa::setDeviceCallback: error creating the notification pipe.";
+    goto error;
+  }
+
+  if ( pthread_create( &notifyThread_, NULL, alsaNotifyHandler, (void *) this ) ) {
+    close( notifyPipe_[0] );
+    close( notifyPipe_[1] );
+    errorText_ = "RtApiAlsa::setDeviceCallback: error creating the notification thread.";
+    goto error;
+  }
+
+  isNotifying_ = true;
+  return true;
+
+ error:
+  if ( notifyFd_ >= 0 ) close( notifyFd_ );
+  notifyFd_ = -1;
+  deviceCallback_ = 0;
+  error( RtAudioError::WARNING );
+  return false;
+}
+
+void RtApiAlsa :: stopDeviceNotification( void )
+{
+  if ( !isNotifying_ ) return;
+
+  // Closing the write end of the pipe wakes the thread.
+  close( notifyPipe_[1] );
+  pthread_join( notifyThread_, NULL );
+  close( notifyPipe_[0] );
+  close( notifyFd_ );
+  notifyFd_ = -1;
+  isNotifying_ = false;
+}
+
+void RtApiAlsa :: deviceEvent( void )
+{
+  struct pollfd pfds[2];
+  pfds[0].fd = notifyFd_;
+  pfds[0].events = POLLIN;
+  pfds[1].fd = notifyPipe_[0];
+  pfds[1].events = POLLIN;
+
+  char events[1024];
+  while ( 1 ) {
+    int result = poll( pfds, 2, -1 );
+    if ( result < 0 && errno == EINTR ) continue;
+    if ( result < 0 || pfds[1].revents ) break;
+
+    // A card creates or removes several nodes, so the change is
+    // reported once they are all done.
+    do {
+      while ( read( notifyFd_, events, sizeof( events ) ) > 0 ) {}
+      result = poll( pfds, 2, ALSA_NOTIFY_DELAY );
+    } while ( result > 0 && !pfds[1].revents );
+    if ( result > 0 ) break;
+
+    deviceCallback_( deviceUserData_ );
+  }
+}
+
+void RtApiAlsa :: updateDeviceList( void )
 {
-  unsigned nDevices = 0;
+  // Any pending change notification invalidates the enumeration.
+  if ( inotifyFd_ >= 0 ) {
+    char events[1024];
+    bool changed = false;
+    while ( read( inotifyFd_, events, sizeof( events ) ) > 0 ) changed = true;
+    if ( isEnumerated_ && !changed ) return;
+  }
+
+  deviceList_.clear();
+  deviceInfo_.clear();
+
   int result, subdevice, card;
-  char name[64];
+  char name[64], cardId[64];
   snd_ctl_t *handle;
+  snd_ctl_card_info_t *cardinfo;
+  snd_ctl_card_info_alloca( &cardinfo );
+  AlsaDevice entry;
+
+  // The capabilities of a device can change with the kernel release.
+  std::string kernel;
+  struct utsname system;
+  if ( uname( &system ) == 0 ) kernel = system.release;
 
   // Count cards and devices
   card = -1;
@@ -6776,23 +9081,38 @@ unsigned int RtApiAlsa :: getDeviceCount( void )
     sprintf( name, "hw:%d", card );
     result = snd_ctl_open( &handle, name, 0 );
     if ( result < 0 ) {
-      errorStream_ << "RtApiAlsa::getDeviceCount: control open, card = " << card << ", " << snd_strerror( result ) << ".";
+      errorStream_ << "RtApiAlsa::updateDeviceList: control open, card = " << card << ", " << snd_strerror( result ) << ".";
       errorText_ = errorStream_.str();
       error( RtAudioError::WARNING );
       goto nextcard;
     }
+    // The card identifier stays the same when other cards come and go.
+    // The long name is left out of the fingerprint, since it includes
+    // the interrupt and bus address, which can change between boots.
+    entry.fingerprint.clear();
+    if ( snd_ctl_card_info( handle, cardinfo ) == 0 ) {
+      snprintf( cardId, sizeof( cardId ), "%s", snd_ctl_card_info_get_id( cardinfo ) );
+      entry.fingerprint = kernel + "|" + cardId + "|" + snd_ctl_card_info_get_driver( cardinfo ) + "|" +
+        snd_ctl_card_info_get_name( cardinfo ) + "|" + snd_ctl_card_info_get_components( cardinfo );
+    }
+    else
+      sprintf( cardId, "%d", card );
     subdevice = -1;
     while( 1 ) {
       result = snd_ctl_pcm_next_device( handle, &subdevice );
       if ( result < 0 ) {
-        errorStream_ << "RtApiAlsa::getDeviceCount: control next device, card = " << card << ", " << snd_strerror( result ) << ".";
+        errorStream_ << "RtApiAlsa::updateDeviceList: control next device, card = " << card << ", " << snd_strerror( result ) << ".";
         errorText_ = errorStream_.str();
         error( RtAudioError::WARNING );
         break;
       }
       if ( subdevice < 0 )
         break;
-      nDevices++;
+      entry.card = card;
+      entry.subdevice = subdevice;
+      snprintf( name, sizeof( name ), "hw:CARD=%s,DEV=%d", cardId, subdevice );
+      entry.identifier = name;
+      deviceList_.push_back( entry );
     }
   nextcard:
     snd_ctl_close( handle );
@@ -6801,91 +9121,97 @@ unsigned int RtApiAlsa :: getDeviceCount( void )
 
   result = snd_ctl_open( &handle, "default", 0 );
   if (result == 0) {
-    nDevices++;
+    entry.card = -1;
+    entry.subdevice = -1;
+    entry.identifier = "default";
+    entry.fingerprint.clear();
+    deviceList_.push_back( entry );
     snd_ctl_close( handle );
   }
 
-  return nDevices;
+  deviceInfo_.resize( deviceList_.size() );
+  isEnumerated_ = true;
 }
 
-RtAudio::DeviceInfo RtApiAlsa :: getDeviceInfo( unsigned int device )
+unsigned int RtApiAlsa :: getDeviceCount( void )
 {
-  RtAudio::DeviceInfo info;
-  info.probed = false;
-
-  unsigned nDevices = 0;
-  int result, subdevice, card;
-  char name[64];
-  snd_ctl_t *chandle;
-
-  // Count cards and devices
-  card = -1;
-  subdevice = -1;
-  snd_card_next( &card );
-  while ( card >= 0 ) {
-    sprintf( name, "hw:%d", card );
-    result = snd_ctl_open( &chandle, name, SND_CTL_NONBLOCK );
-    if ( result < 0 ) {
-      errorStream_ << "RtApiAlsa::getDeviceInfo: control open, card = " << card << ", " << snd_strerror( result ) << ".";
-      errorText_ = errorStream_.str();
-      error( RtAudioError::WARNING );
-      goto nextcard;
-    }
-    subdevice = -1;
-    while( 1 ) {
-      result = snd_ctl_pcm_next_device( chandle, &subdevice );
-      if ( result < 0 ) {
-        errorStream_ << "RtApiAlsa::getDeviceInfo: control next device, card = " << card << ", " << snd_strerror( result ) << ".";
-        errorText_ = errorStream_.str();
-        error( RtAudioError::WARNING );
-        break;
-      }
-      if ( subdevice < 0 ) break;
-      if ( nDevices == device ) {
-        sprintf( name, "hw:%d,%d", card, subdevice );
-        goto foundDevice;
-      }
-      nDevices++;
-    }
-  nextcard:
-    snd_ctl_close( chandle );
-    snd_card_next( &card );
-  }
-
-  result = snd_ctl_open( &chandle, "default", SND_CTL_NONBLOCK );
-  if ( result == 0 ) {
-    if ( nDevices == device ) {
-      strcpy( name, "default" );
-      goto foundDevice;
-    }
-    nDevices++;
-  }
+  updateDeviceList();
+  return deviceList_.size();
+}
 
-  if ( nDevices == 0 ) {
+RtAudio::DeviceInfo RtApiAlsa :: getDeviceInfo( unsigned int device )
+{
+  updateDeviceList();
+  if ( deviceList_.size() == 0 ) {
     errorText_ = "RtApiAlsa::getDeviceInfo: no devices found!";
     error( RtAudioError::INVALID_USE );
-    return info;
+    return RtAudio::DeviceInfo();
   }
 
-  if ( device >= nDevices ) {
+  if ( device >= deviceList_.size() ) {
     errorText_ = "RtApiAlsa::getDeviceInfo: device ID is invalid!";
     error( RtAudioError::INVALID_USE );
-    return info;
+    return RtAudio::DeviceInfo();
   }
 
- foundDevice:
+  // The information of a device is probed once per enumeration.  A
+  // device probed without its capabilities has no native formats.
+  if ( !deviceInfo_[device].probed || deviceInfo_[device].nativeFormats == 0 )
+    probeDevices( std::vector<unsigned int>( 1, device ), true );
+  return deviceInfo_[device];
+}
 
-  // If a stream is already open, we cannot probe the stream devices.
-  // Thus, use the saved results.
-  if ( stream_.state != STREAM_CLOSED &&
-       ( stream_.device[0] == device || stream_.device[1] == device ) ) {
-    snd_ctl_close( chandle );
-    if ( device >= devices_.size() ) {
-      errorText_ = "RtApiAlsa::getDeviceInfo: device ID was not present before stream was opened.";
-      error( RtAudioError::WARNING );
-      return info;
+std::vector<RtAudio::DeviceInfo> RtApiAlsa :: getDevices( bool probeCapabilities )
+{
+  updateDeviceList();
+  std::vector<unsigned int> devices;
+  for ( unsigned int i=0; i<deviceInfo_.size(); i++ ) {
+    if ( !deviceInfo_[i].probed || ( probeCapabilities && deviceInfo_[i].nativeFormats == 0 ) )
+      devices.push_back( i );
+  }
+  if ( devices.size() ) probeDevices( devices, probeCapabilities );
+  return deviceInfo_;
+}
+
+bool RtApiAlsa :: findDevice( const std::string &identifier, unsigned int *device )
+{
+  // The identifiers are known from the enumeration, without a probe.
+  updateDeviceList();
+  for ( unsigned int i=0; i<deviceList_.size(); i++ ) {
+    if ( deviceList_[i].identifier == identifier ) {
+      *device = i;
+      return true;
     }
-    return devices_[ device ];
+  }
+  return false;
+}
+
+// Probes the channels of a device and, if requested, the given sample
+// rates and the formats.  It does not use the RtApiAlsa object, such
+// that it can run on a worker thread, and appends its warnings to the
+// given stream, one per line.
+static RtAudio::DeviceInfo probeAlsaDevice( int card, int subdevice, bool isFirst, bool probeCapabilities,
+                                           const std::vector<unsigned int> &rates, std::ostringstream &warnings )
+{
+  RtAudio::DeviceInfo info;
+  info.probed = false;
+
+  int result;
+  char name[64];
+  snd_ctl_t *chandle;
+
+  if ( subdevice < 0 ) {
+    strcpy( name, "default" );
+    result = snd_ctl_open( &chandle, name, SND_CTL_NONBLOCK );
+  }
+  else {
+    sprintf( name, "hw:%d", card );
+    result = snd_ctl_open( &chandle, name, SND_CTL_NONBLOCK );
+    sprintf( name, "hw:%d,%d", card, subdevice );
+  }
+  if ( result < 0 ) {
+    warnings << "RtApiAlsa::getDeviceInfo: control open, card = " << card << ", " << snd_strerror( result ) << ".\n";
+    return info;
   }
 
   int openMode = SND_PCM_ASYNC;
@@ -6912,9 +9238,7 @@ RtAudio::DeviceInfo RtApiAlsa :: getDeviceInfo( unsigned int device )
 
   result = snd_pcm_open( &phandle, name, stream, openMode | SND_PCM_NONBLOCK );
   if ( result < 0 ) {
-    errorStream_ << "RtApiAlsa::getDeviceInfo: snd_pcm_open error for device (" << name << "), " << snd_strerror( result ) << ".";
-    errorText_ = errorStream_.str();
-    error( RtAudioError::WARNING );
+    warnings << "RtApiAlsa::getDeviceInfo: snd_pcm_open error for device (" << name << "), " << snd_strerror( result ) << ".\n";
     goto captureProbe;
   }
 
@@ -6922,9 +9246,7 @@ RtAudio::DeviceInfo RtApiAlsa :: getDeviceInfo( unsigned int device )
   result = snd_pcm_hw_params_any( phandle, params );
   if ( result < 0 ) {
     snd_pcm_close( phandle );
-    errorStream_ << "RtApiAlsa::getDeviceInfo: snd_pcm_hw_params error for device (" << name << "), " << snd_strerror( result ) << ".";
-    errorText_ = errorStream_.str();
-    error( RtAudioError::WARNING );
+    warnings << "RtApiAlsa::getDeviceInfo: snd_pcm_hw_params error for device (" << name << "), " << snd_strerror( result ) << ".\n";
     goto captureProbe;
   }
 
@@ -6933,9 +9255,7 @@ RtAudio::DeviceInfo RtApiAlsa :: getDeviceInfo( unsigned int device )
   result = snd_pcm_hw_params_get_channels_max( params, &value );
   if ( result < 0 ) {
     snd_pcm_close( phandle );
-    errorStream_ << "RtApiAlsa::getDeviceInfo: error getting device (" << name << ") output channels, " << snd_strerror( result ) << ".";
-    errorText_ = errorStream_.str();
-    error( RtAudioError::WARNING );
+    warnings << "RtApiAlsa::getDeviceInfo: error getting device (" << name << ") output channels, " << snd_strerror( result ) << ".\n";
     goto captureProbe;
   }
   info.outputChannels = value;
@@ -6960,9 +9280,7 @@ RtAudio::DeviceInfo RtApiAlsa :: getDeviceInfo( unsigned int device )
 
   result = snd_pcm_open( &phandle, name, stream, openMode | SND_PCM_NONBLOCK);
   if ( result < 0 ) {
-    errorStream_ << "RtApiAlsa::getDeviceInfo: snd_pcm_open error for device (" << name << "), " << snd_strerror( result ) << ".";
-    errorText_ = errorStream_.str();
-    error( RtAudioError::WARNING );
+    warnings << "RtApiAlsa::getDeviceInfo: snd_pcm_open error for device (" << name << "), " << snd_strerror( result ) << ".\n";
     if ( info.outputChannels == 0 ) return info;
     goto probeParameters;
   }
@@ -6971,9 +9289,7 @@ RtAudio::DeviceInfo RtApiAlsa :: getDeviceInfo( unsigned int device )
   result = snd_pcm_hw_params_any( phandle, params );
   if ( result < 0 ) {
     snd_pcm_close( phandle );
-    errorStream_ << "RtApiAlsa::getDeviceInfo: snd_pcm_hw_params error for device (" << name << "), " << snd_strerror( result ) << ".";
-    errorText_ = errorStream_.str();
-    error( RtAudioError::WARNING );
+    warnings << "RtApiAlsa::getDeviceInfo: snd_pcm_hw_params error for device (" << name << "), " << snd_strerror( result ) << ".\n";
     if ( info.outputChannels == 0 ) return info;
     goto probeParameters;
   }
@@ -6981,9 +9297,7 @@ RtAudio::DeviceInfo RtApiAlsa :: getDeviceInfo( unsigned int device )
   result = snd_pcm_hw_params_get_channels_max( params, &value );
   if ( result < 0 ) {
     snd_pcm_close( phandle );
-    errorStream_ << "RtApiAlsa::getDeviceInfo: error getting device (" << name << ") input channels, " << snd_strerror( result ) << ".";
-    errorText_ = errorStream_.str();
-    error( RtAudioError::WARNING );
+    warnings << "RtApiAlsa::getDeviceInfo: error getting device (" << name << ") input channels, " << snd_strerror( result ) << ".\n";
     if ( info.outputChannels == 0 ) return info;
     goto probeParameters;
   }
@@ -6995,12 +9309,14 @@ RtAudio::DeviceInfo RtApiAlsa :: getDeviceInfo( unsigned int device )
     info.duplexChannels = (info.outputChannels > info.inputChannels) ? info.inputChannels : info.outputChannels;
 
   // ALSA doesn't provide default devices so we'll use the first available one.
-  if ( device == 0 && info.outputChannels > 0 )
+  if ( isFirst && info.outputChannels > 0 )
     info.isDefaultOutput = true;
-  if ( device == 0 && info.inputChannels > 0 )
+  if ( isFirst && info.inputChannels > 0 )
     info.isDefaultInput = true;
 
  probeParameters:
+  if ( !probeCapabilities ) goto probeName;
+
   // At this point, we just need to figure out the supported data
   // formats and sample rates.  We'll proceed by opening the device in
   // the direction with the maximum number of channels, or playback if
@@ -7015,9 +9331,7 @@ RtAudio::DeviceInfo RtApiAlsa :: getDeviceInfo( unsigned int device )
 
   result = snd_pcm_open( &phandle, name, stream, openMode | SND_PCM_NONBLOCK);
   if ( result < 0 ) {
-    errorStream_ << "RtApiAlsa::getDeviceInfo: snd_pcm_open error for device (" << name << "), " << snd_strerror( result ) << ".";
-    errorText_ = errorStream_.str();
-    error( RtAudioError::WARNING );
+    warnings << "RtApiAlsa::getDeviceInfo: snd_pcm_open error for device (" << name << "), " << snd_strerror( result ) << ".\n";
     return info;
   }
 
@@ -7025,27 +9339,51 @@ RtAudio::DeviceInfo RtApiAlsa :: getDeviceInfo( unsigned int device )
   result = snd_pcm_hw_params_any( phandle, params );
   if ( result < 0 ) {
     snd_pcm_close( phandle );
-    errorStream_ << "RtApiAlsa::getDeviceInfo: snd_pcm_hw_params error for device (" << name << "), " << snd_strerror( result ) << ".";
-    errorText_ = errorStream_.str();
-    error( RtAudioError::WARNING );
+    warnings << "RtApiAlsa::getDeviceInfo: snd_pcm_hw_params error for device (" << name << "), " << snd_strerror( result ) << ".\n";
     return info;
   }
 
-  // Test our discrete set of sample rate values.
+  // Test our discrete set of sample rate values, within the range
+  // supported.  A range that also accepts the rate just above its
+  // minimum is continuous, so its standard rates need no test.  The
+  // limits of a discrete range are supported rates of their own.
   info.sampleRates.clear();
-  for ( unsigned int i=0; i<MAX_SAMPLE_RATES; i++ ) {
-    if ( snd_pcm_hw_params_test_rate( phandle, params, SAMPLE_RATES[i], 0 ) == 0 ) {
-      info.sampleRates.push_back( SAMPLE_RATES[i] );
+  {
+    unsigned int minRate, maxRate;
+    int dir = 0;
+    bool isContinuous = false;
+    if ( snd_pcm_hw_params_get_rate_min( params, &minRate, &dir ) < 0 ||
+         snd_pcm_hw_params_get_rate_max( params, &maxRate, &dir ) < 0 ) {
+      minRate = 0;
+      maxRate = UINT_MAX;
+    }
+    else {
+      info.minSampleRate = minRate;
+      info.maxSampleRate = maxRate;
+      isContinuous = ( maxRate > minRate + 1 && snd_pcm_hw_params_test_rate( phandle, params, minRate + 1, 0 ) == 0 );
+      if ( !isContinuous ) info.sampleRates.push_back( minRate );
+    }
 
-      if ( !info.preferredSampleRate || ( SAMPLE_RATES[i] <= 48000 && SAMPLE_RATES[i] > info.preferredSampleRate ) )
-        info.preferredSampleRate = SAMPLE_RATES[i];
+    for ( unsigned int i=0; i<rates.size(); i++ ) {
+      if ( rates[i] < minRate || rates[i] > maxRate ) continue;
+      if ( isContinuous || snd_pcm_hw_params_test_rate( phandle, params, rates[i], 0 ) == 0 ) {
+        if ( info.sampleRates.empty() || info.sampleRates.back() != rates[i] )
+          info.sampleRates.push_back( rates[i] );
+
+        if ( !info.preferredSampleRate || ( rates[i] <= 48000 && rates[i] > info.preferredSampleRate ) )
+          info.preferredSampleRate = rates[i];
+      }
     }
+
+    if ( !isContinuous && info.maxSampleRate && info.sampleRates.back() != maxRate )
+      info.sampleRates.push_back( maxRate );
+
+    if ( !info.preferredSampleRate && info.maxSampleRate )
+      info.preferredSampleRate = maxRate;
   }
   if ( info.sampleRates.size() == 0 ) {
     snd_pcm_close( phandle );
-    errorStream_ << "RtApiAlsa::getDeviceInfo: no supported sample rates found for device (" << name << ").";
-    errorText_ = errorStream_.str();
-    error( RtAudioError::WARNING );
+    warnings << "RtApiAlsa::getDeviceInfo: no supported sample rates found for device (" << name << ").\n";
     return info;
   }
 
@@ -7074,13 +9412,14 @@ RtAudio::DeviceInfo RtApiAlsa :: getDeviceInfo( unsigned int device )
   // Check that we have at least one supported format
   if ( info.nativeFormats == 0 ) {
     snd_pcm_close( phandle );
-    errorStream_ << "RtApiAlsa::getDeviceInfo: pcm device (" << name << ") data format not supported by RtAudio.";
-    errorText_ = errorStream_.str();
-    error( RtAudioError::WARNING );
+    warnings << "RtApiAlsa::getDeviceInfo: pcm device (" << name << ") data format not supported by RtAudio.\n";
     return info;
   }
 
-  // Get the device name
+  // That's all ... close the device and get its name.
+  snd_pcm_close( phandle );
+
+ probeName:
   char *cardname;
   result = snd_card_get_name( card, &cardname );
   if ( result >= 0 ) {
@@ -7088,21 +9427,498 @@ RtAudio::DeviceInfo RtApiAlsa :: getDeviceInfo( unsigned int device )
     free( cardname );
   }
   info.name = name;
-
-  // That's all ... close the device and return
-  snd_pcm_close( phandle );
   info.probed = true;
   return info;
 }
 
-void RtApiAlsa :: saveDeviceInfo( void )
+// The number of worker threads that probe devices, and the time after
+// which a device that has not been probed is given up.
+static const unsigned int ALSA_PROBE_THREADS = 4;
+static const double ALSA_PROBE_TIMEOUT = 2.0;
+
+// A structure shared by the thread that probes devices and its
+// workers.  A worker blocked on a device can outlive the probing
+// thread, so the last one to release it deletes it.
+struct AlsaProbeJob {
+  enum ProbeState { PENDING, RUNNING, DONE, ABANDONED };
+  struct Probe {
+    unsigned int device;
+    int card;
+    int subdevice;
+    std::string identifier;
+    ProbeState state;
+    double startTime;
+    RtAudio::DeviceInfo info;
+    std::string warnings;
+  };
+  std::vector<Probe> probes;
+  std::vector<unsigned int> rates; // The sample rates to test.
+  bool probeCapabilities;
+  unsigned int next;        // The next probe for a worker to take.
+  unsigned int references;  // The probing thread and the workers.
+  pthread_mutex_t mutex;
+  pthread_cond_t done;      // Signaled when a probe is done.
+
+  AlsaProbeJob()
+    :probeCapabilities(true), next(0), references(1)
+  {
+    pthread_mutex_init( &mutex, NULL );
+    pthread_condattr_t attributes;
+    pthread_condattr_init( &attributes );
+    pthread_condattr_setclock( &attributes, CLOCK_MONOTONIC );
+    pthread_cond_init( &done, &attributes );
+    pthread_condattr_destroy( &attributes );
+  }
+  ~AlsaProbeJob() { pthread_cond_destroy( &done ); pthread_mutex_destroy( &mutex ); }
+};
+
+// The identifiers of the devices whose probe timed out and whose
+// worker is still blocked, for all instances.  Such a device is not
+// probed again until its worker returns, such that a hung device
+// does not stall every query and collect blocked threads.  The list
+// is never deleted, since a blocked worker can outlive main().
+static pthread_mutex_t alsaStuckMutex = PTHREAD_MUTEX_INITIALIZER;
+static std::vector<std::string> *alsaStuckDevices = NULL;
+
+static bool isAlsaDeviceStuck( const std::string &identifier )
 {
-  devices_.clear();
+  MUTEX_LOCK( &alsaStuckMutex );
+  bool isStuck = alsaStuckDevices &&
+    std::find( alsaStuckDevices->begin(), alsaStuckDevices->end(), identifier ) != alsaStuckDevices->end();
+  MUTEX_UNLOCK( &alsaStuckMutex );
+  return isStuck;
+}
+
+static void setAlsaDeviceStuck( const std::string &identifier, bool isStuck )
+{
+  MUTEX_LOCK( &alsaStuckMutex );
+  if ( alsaStuckDevices == NULL ) alsaStuckDevices = new std::vector<std::string>;
+  std::vector<std::string>::iterator it = std::find( alsaStuckDevices->begin(), alsaStuckDevices->end(), identifier );
+  if ( isStuck && it == alsaStuckDevices->end() ) alsaStuckDevices->push_back( identifier );
+  if ( !isStuck && it != alsaStuckDevices->end() ) alsaStuckDevices->erase( it );
+  MUTEX_UNLOCK( &alsaStuckMutex );
+}
+
+static void releaseAlsaProbeJob( AlsaProbeJob *job )
+{
+  MUTEX_LOCK( &job->mutex );
+  bool isLast = ( --job->references == 0 );
+  MUTEX_UNLOCK( &job->mutex );
+  if ( isLast ) delete job;
+}
+
+static void *alsaProbeHandler( void *ptr )
+{
+  AlsaProbeJob *job = (AlsaProbeJob *) ptr;
+  MUTEX_LOCK( &job->mutex );
+  while ( job->next < job->probes.size() ) {
+    AlsaProbeJob::Probe &probe = job->probes[ job->next++ ];
+    probe.state = AlsaProbeJob::RUNNING;
+    probe.startTime = getMonotonicTime();
+    MUTEX_UNLOCK( &job->mutex );
+
+    std::ostringstream warnings;
+    RtAudio::DeviceInfo info = probeAlsaDevice( probe.card, probe.subdevice, probe.device == 0,
+                                                job->probeCapabilities, job->rates, warnings );
+
+    MUTEX_LOCK( &job->mutex );
+    if ( probe.state == AlsaProbeJob::RUNNING ) {
+      probe.info = info;
+      probe.warnings = warnings.str();
+      probe.state = AlsaProbeJob::DONE;
+      pthread_cond_signal( &job->done );
+    }
+    else
+      setAlsaDeviceStuck( probe.identifier, false );
+  }
+  MUTEX_UNLOCK( &job->mutex );
+
+  releaseAlsaProbeJob( job );
+  return NULL;
+}
+
+// Starts a detached worker for a probe job, which must be locked.
+static bool startAlsaProbeThread( AlsaProbeJob *job )
+{
+  pthread_t thread;
+  job->references++;
+  if ( pthread_create( &thread, NULL, alsaProbeHandler, job ) ) {
+    job->references--;
+    return false;
+  }
+  pthread_detach( thread );
+  return true;
+}
+
+void RtApiAlsa :: probeDevices( const std::vector<unsigned int> &devices, bool probeCapabilities )
+{
+  readDeviceCache();
+
+  AlsaProbeJob *job = new AlsaProbeJob;
+  job->rates.assign( SAMPLE_RATES, SAMPLE_RATES + MAX_SAMPLE_RATES );
+  job->probeCapabilities = probeCapabilities;
+  AlsaProbeJob::Probe probe;
+  probe.state = AlsaProbeJob::PENDING;
+  probe.startTime = 0.0;
+  std::vector<std::string> warnings;
+  for ( unsigned int i=0; i<devices.size(); i++ ) {
+    // If a stream of this or a sharing instance is already open, we
+    // cannot probe the stream devices.  Thus, use the saved results.
+    if ( isDeviceOpen( devices[i] ) ) {
+      if ( !getSavedDeviceInfo( devices[i], deviceInfo_[ devices[i] ] ) ) {
+        errorText_ = "RtApiAlsa::getDeviceInfo: device ID was not present before stream was opened.";
+        error( RtAudioError::WARNING );
+      }
+      continue;
+    }
+    if ( getCachedDeviceInfo( devices[i] ) ) continue;
+    if ( isAlsaDeviceStuck( deviceList_[ devices[i] ].identifier ) ) {
+      deviceInfo_[ devices[i] ] = RtAudio::DeviceInfo();
+      deviceInfo_[ devices[i] ].identifier = deviceList_[ devices[i] ].identifier;
+      warnings.push_back( "RtApiAlsa::getDeviceInfo: device (" + deviceList_[ devices[i] ].identifier +
+                          ") is not responding since an earlier probe timed out." );
+      continue;
+    }
+    probe.device = devices[i];
+    probe.card = deviceList_[ devices[i] ].card;
+    probe.subdevice = deviceList_[ devices[i] ].subdevice;
+    probe.identifier = deviceList_[ devices[i] ].identifier;
+    job->probes.push_back( probe );
+  }
+
+  // The devices are probed concurrently, each within a timeout.  The
+  // worker of a device that times out is abandoned and replaced.  A
+  // single device is probed by this thread.
+  MUTEX_LOCK( &job->mutex );
+  if ( job->probes.size() > 1 ) {
+    for ( unsigned int i=0; i<ALSA_PROBE_THREADS && i<job->probes.size(); i++ )
+      if ( !startAlsaProbeThread( job ) ) break;
+  }
+  if ( job->references == 1 && job->probes.size() ) {
+    // Without a worker, the devices are probed by this thread.
+    job->references++;
+    MUTEX_UNLOCK( &job->mutex );
+    alsaProbeHandler( job );
+    MUTEX_LOCK( &job->mutex );
+  }
+
+  while ( 1 ) {
+    double now = getMonotonicTime();
+    double deadline = 0.0;
+    unsigned int remaining = 0;
+    for ( unsigned int i=0; i<job->probes.size(); i++ ) {
+      AlsaProbeJob::Probe &probe = job->probes[i];
+      if ( probe.state == AlsaProbeJob::RUNNING && now - probe.startTime > ALSA_PROBE_TIMEOUT ) {
+        probe.state = AlsaProbeJob::ABANDONED;
+        setAlsaDeviceStuck( probe.identifier, true );
+        if ( job->next < job->probes.size() ) startAlsaProbeThread( job );
+      }
+      if ( probe.state == AlsaProbeJob::RUNNING &&
+           ( deadline == 0.0 || probe.startTime + ALSA_PROBE_TIMEOUT < deadline ) )
+        deadline = probe.startTime + ALSA_PROBE_TIMEOUT;
+      if ( probe.state == AlsaProbeJob::PENDING || probe.state == AlsaProbeJob::RUNNING )
+        remaining++;
+    }
+    if ( remaining == 0 ) break;
+
+    if ( deadline == 0.0 ) {
+      // Without a running worker, the devices left are probed by this
+      // thread.
+      job->references++;
+      MUTEX_UNLOCK( &job->mutex );
+      alsaProbeHandler( job );
+      MUTEX_LOCK( &job->mutex );
+      continue;
+    }
+
+    // Wait for a probe to be done or for the first one to time out.
+    struct timespec time;
+    time.tv_sec = (time_t) deadline;
+    time.tv_nsec = (long) ( ( deadline - time.tv_sec ) * 1e9 );
+    pthread_cond_timedwait( &job->done, &job->mutex, &time );
+  }
+
+  bool isCacheChanged = false;
+  for ( unsigned int i=0; i<job->probes.size(); i++ ) {
+    AlsaProbeJob::Probe &probe = job->probes[i];
+    if ( probe.state == AlsaProbeJob::ABANDONED ) {
+      deviceInfo_[ probe.device ] = RtAudio::DeviceInfo();
+      deviceInfo_[ probe.device ].identifier = deviceList_[ probe.device ].identifier;
+      errorStream_ << "RtApiAlsa::getDeviceInfo: timeout probing device (hw:" << probe.card << "," << probe.subdevice << ").";
+      warnings.push_back( errorStream_.str() );
+      errorStream_.str( "" );
+      continue;
+    }
+    deviceInfo_[ probe.device ] = probe.info;
+    deviceInfo_[ probe.device ].identifier = deviceList_[ probe.device ].identifier;
+    if ( probeCapabilities && probe.info.probed && !deviceCacheFile_.empty() &&
+         !deviceList_[ probe.device ].fingerprint.empty() ) {
+      setCachedDeviceInfo( probe.device );
+      isCacheChanged = true;
+    }
+    std::istringstream lines( probe.warnings );
+    std::string line;
+    while ( std::getline( lines, line ) ) warnings.push_back( line );
+  }
+  MUTEX_UNLOCK( &job->mutex );
+  releaseAlsaProbeJob( job );
+
+  if ( isCacheChanged ) writeDeviceCache();
+
+  for ( unsigned int i=0; i<warnings.size(); i++ ) {
+    errorText_ = warnings[i];
+    error( RtAudioError::WARNING );
+  }
+}
+
+bool RtApiAlsa :: getCachedDeviceInfo( unsigned int device )
+{
+  if ( deviceCacheFile_.empty() || deviceList_[device].fingerprint.empty() ) return false;
+
+  for ( unsigned int i=0; i<deviceCache_.size(); i++ ) {
+    CachedDevice &cached = deviceCache_[i];
+    if ( cached.identifier != deviceList_[device].identifier ) continue;
+    if ( cached.fingerprint != deviceList_[device].fingerprint ) return false;
+
+    // The default flags depend on the position of the device.
+    RtAudio::DeviceInfo &info = deviceInfo_[device];
+    info = cached.info;
+    info.isDefaultOutput = ( device == 0 && info.outputChannels > 0 );
+    info.isDefaultInput = ( device == 0 && info.inputChannels > 0 );
+    return true;
+  }
+  return false;
+}
+
+void RtApiAlsa :: setCachedDeviceInfo( unsigned int device )
+{
+  unsigned int i = 0;
+  while ( i < deviceCache_.size() && deviceCache_[i].identifier != deviceList_[device].identifier ) i++;
+  if ( i == deviceCache_.size() ) deviceCache_.push_back( CachedDevice() );
+
+  deviceCache_[i].identifier = deviceList_[device].identifier;
+  deviceCache_[i].fingerprint = deviceList_[device].fingerprint;
+  deviceCache_[i].info = deviceInfo_[device];
+}
 
+// The device cache file starts with a version line, followed by a
+// line per device with tab separated fields: the identifier, the
+// fingerprint, the name, the output, input and duplex channels, the
+// preferred sample rate, the native formats, the minimum and maximum
+// sample rates, and the comma separated sample rates.
+static const char *ALSA_CACHE_VERSION = "RtAudio ALSA device cache 2";
+
+void RtApiAlsa :: readDeviceCache( void )
+{
+  if ( deviceCacheFile_ == deviceCacheRead_ ) return;
+  deviceCache_.clear();
+  deviceCacheRead_ = deviceCacheFile_;
+  if ( deviceCacheFile_.empty() ) return;
+
+  // A missing or unreadable file just leaves the cache empty.
+  std::ifstream file( deviceCacheFile_.c_str() );
+  std::string line;
+  if ( !std::getline( file, line ) || line != ALSA_CACHE_VERSION ) return;
+
+  while ( std::getline( file, line ) ) {
+    std::vector<std::string> fields;
+    std::istringstream values( line );
+    std::string field;
+    while ( std::getline( values, field, '\t' ) ) fields.push_back( field );
+    if ( fields.size() < 10 ) continue;
+
+    CachedDevice cached;
+    cached.identifier = fields[0];
+    cached.fingerprint = fields[1];
+    RtAudio::DeviceInfo &info = cached.info;
+    info.probed = true;
+    info.name = fields[2];
+    info.identifier = fields[0];
+    info.outputChannels = strtoul( fields[3].c_str(), NULL, 10 );
+    info.inputChannels = strtoul( fields[4].c_str(), NULL, 10 );
+    info.duplexChannels = strtoul( fields[5].c_str(), NULL, 10 );
+    info.preferredSampleRate = strtoul( fields[6].c_str(), NULL, 10 );
+    info.nativeFormats = strtoul( fields[7].c_str(), NULL, 10 );
+    info.minSampleRate = strtoul( fields[8].c_str(), NULL, 10 );
+    info.maxSampleRate = strtoul( fields[9].c_str(), NULL, 10 );
+    if ( fields.size() > 10 ) {
+      std::istringstream rates( fields[10] );
+      while ( std::getline( rates, field, ',' ) )
+        info.sampleRates.push_back( strtoul( field.c_str(), NULL, 10 ) );
+    }
+    if ( info.nativeFormats == 0 ) continue;
+    deviceCache_.push_back( cached );
+  }
+}
+
+void RtApiAlsa :: writeDeviceCache( void )
+{
+  // The file is replaced at once, such that processes starting at
+  // the same time never read a partial file.
+  std::ostringstream name;
+  name << deviceCacheFile_ << "." << getpid();
+  std::string temporary = name.str();
+  std::ofstream file( temporary.c_str() );
+  file << ALSA_CACHE_VERSION << '\n';
+  for ( unsigned int i=0; i<deviceCache_.size(); i++ ) {
+    const RtAudio::DeviceInfo &info = deviceCache_[i].info;
+    std::string deviceName = info.name;
+    std::replace( deviceName.begin(), deviceName.end(), '\t', ' ' );
+    std::replace( deviceName.begin(), deviceName.end(), '\n', ' ' );
+    file << deviceCache_[i].identifier << '\t' << deviceCache_[i].fingerprint << '\t' << deviceName << '\t'
+         << info.outputChannels << '\t' << info.inputChannels << '\t' << info.duplexChannels << '\t'
+         << info.preferredSampleRate << '\t' << info.nativeFormats << '\t'
+         << info.minSampleRate << '\t' << info.maxSampleRate << '\t';
+    for ( unsigned int j=0; j<info.sampleRates.size(); j++ )
+      file << ( j ? "," : "" ) << info.sampleRates[j];
+    file << '\n';
+  }
+  file.close();
+
+  if ( file.fail() || rename( temporary.c_str(), deviceCacheFile_.c_str() ) != 0 ) {
+    remove( temporary.c_str() );
+    errorText_ = "RtApiAlsa::writeDeviceCache: error writing the device cache file (" + deviceCacheFile_ + ").";
+    error( RtAudioError::WARNING );
+  }
+}
+
+void RtApiAlsa :: saveDeviceInfo( void )
+{
   unsigned int nDevices = getDeviceCount();
-  devices_.resize( nDevices );
-  for ( unsigned int i=0; i<nDevices; i++ )
-    devices_[i] = getDeviceInfo( i );
+
+  // Instances created by RtAudio::createStreamHandle() share the
+  // saved information, so it is only probed again when the devices
+  // have changed.  A device is identified by its card identifier,
+  // since the number of devices stays the same when one is swapped.
+  if ( isContextShared() && getSavedDeviceCount() == nDevices ) {
+    RtAudio::DeviceInfo info;
+    unsigned int i = 0;
+    while ( i < nDevices && getSavedDeviceInfo( i, info ) &&
+            info.identifier == deviceList_[i].identifier ) i++;
+    if ( i == nDevices ) return;
+  }
+
+  setSavedDeviceInfo( getDevices( true ) );
+}
+
+// The largest number of periods considered for a latency target.
+static const unsigned int ALSA_MAX_TARGET_PERIODS = 8;
+
+// Searches the period sizes and counts supported by a device for the
+// configuration with the fewest wakeups per second that does not
+// exceed the target latency, using as many periods as fit.  If no
+// configuration meets the target, the lowest latency is chosen.
+static void findAlsaBuffering( snd_pcm_t *handle, snd_pcm_hw_params_t *hw_params, unsigned int targetFrames,
+                               snd_pcm_uframes_t *periodSize, unsigned int *periods )
+{
+  snd_pcm_hw_params_t *test;
+  snd_pcm_hw_params_alloca( &test );
+  snd_pcm_uframes_t bestSize = 0;
+  unsigned int bestPeriods = 0;
+  unsigned long bestLatency = 0;
+  bool bestMeetsTarget = false;
+
+  for ( unsigned int n=2; n<=ALSA_MAX_TARGET_PERIODS; n++ ) {
+    snd_pcm_hw_params_copy( test, hw_params );
+    snd_pcm_uframes_t size = targetFrames / n;
+    if ( size == 0 ) size = 1;
+    unsigned int count = n;
+    int dir = 0;
+    if ( snd_pcm_hw_params_set_period_size_near( handle, test, &size, &dir ) < 0 ) continue;
+    dir = 0;
+    if ( snd_pcm_hw_params_set_periods_near( handle, test, &count, &dir ) < 0 ) continue;
+
+    unsigned long latency = size * count;
+    bool meetsTarget = ( latency <= targetFrames );
+    bool isBetter;
+    if ( bestPeriods == 0 ) isBetter = true;
+    else if ( meetsTarget != bestMeetsTarget ) isBetter = meetsTarget;
+    else if ( meetsTarget ) isBetter = ( size > bestSize || ( size == bestSize && count > bestPeriods ) );
+    else isBetter = ( latency < bestLatency );
+
+    if ( isBetter ) {
+      bestSize = size;
+      bestPeriods = count;
+      bestLatency = latency;
+      bestMeetsTarget = meetsTarget;
+    }
+  }
+
+  if ( bestPeriods ) {
+    *periodSize = bestSize;
+    *periods = bestPeriods;
+  }
+}
+
+// Installs the software configuration of a device, which fills the
+// buffer with zeros and prevents the device from stopping on xruns.
+static int setAlsaSwParams( snd_pcm_t *handle, snd_pcm_uframes_t periodSize, snd_pcm_uframes_t availMin )
+{
+  snd_pcm_sw_params_t *sw_params = NULL;
+  snd_pcm_sw_params_alloca( &sw_params );
+  snd_pcm_sw_params_current( handle, sw_params );
+  snd_pcm_sw_params_set_start_threshold( handle, sw_params, periodSize );
+  snd_pcm_sw_params_set_stop_threshold( handle, sw_params, ULONG_MAX );
+  snd_pcm_sw_params_set_avail_min( handle, sw_params, availMin );
+  snd_pcm_sw_params_set_silence_threshold( handle, sw_params, 0 );
+
+  // The following setting was suggested by Theo Veenker
+  //snd_pcm_sw_params_set_xfer_align( handle, sw_params, 1 );
+
+  // here are two options for a fix
+  //snd_pcm_sw_params_set_silence_size( handle, sw_params, ULONG_MAX );
+  snd_pcm_uframes_t val;
+  snd_pcm_sw_params_get_boundary( sw_params, &val );
+  snd_pcm_sw_params_set_silence_size( handle, sw_params, val );
+
+  return snd_pcm_sw_params( handle, sw_params );
+}
+
+// Sets the number of frames that start a prepared device when they
+// are written or read.  A value of zero disables the automatic start.
+static int setAlsaStartThreshold( snd_pcm_t *handle, snd_pcm_uframes_t frames )
+{
+  snd_pcm_sw_params_t *sw_params;
+  snd_pcm_sw_params_alloca( &sw_params );
+  int result = snd_pcm_sw_params_current( handle, sw_params );
+  if ( result < 0 ) return result;
+  if ( frames == 0 ) snd_pcm_sw_params_get_boundary( sw_params, &frames );
+  result = snd_pcm_sw_params_set_start_threshold( handle, sw_params, frames );
+  if ( result < 0 ) return result;
+  return snd_pcm_sw_params( handle, sw_params );
+}
+
+// Installs the hardware configuration of an open device again with a
+// new sample rate and period size, keeping its access, format,
+// channels and number of periods.
+static int resetAlsaHwParams( snd_pcm_t *handle, unsigned int *sampleRate,
+                              snd_pcm_uframes_t *periodSize, unsigned int *periods )
+{
+  snd_pcm_hw_params_t *hw_params;
+  snd_pcm_hw_params_alloca( &hw_params );
+  int result = snd_pcm_hw_params_current( handle, hw_params );
+  if ( result < 0 ) return result;
+
+  snd_pcm_access_t access;
+  snd_pcm_format_t format;
+  unsigned int channels;
+  int dir = 0;
+  snd_pcm_hw_params_get_access( hw_params, &access );
+  snd_pcm_hw_params_get_format( hw_params, &format );
+  snd_pcm_hw_params_get_channels( hw_params, &channels );
+  snd_pcm_hw_params_get_periods( hw_params, periods, &dir );
+
+  result = snd_pcm_hw_free( handle );
+  if ( result >= 0 ) result = snd_pcm_hw_params_any( handle, hw_params );
+  if ( result >= 0 ) result = snd_pcm_hw_params_set_access( handle, hw_params, access );
+  if ( result >= 0 ) result = snd_pcm_hw_params_set_format( handle, hw_params, format );
+  if ( result >= 0 ) result = snd_pcm_hw_params_set_channels( handle, hw_params, channels );
+  if ( result >= 0 ) result = snd_pcm_hw_params_set_rate_near( handle, hw_params, sampleRate, 0 );
+  dir = 0;
+  if ( result >= 0 ) result = snd_pcm_hw_params_set_period_size_near( handle, hw_params, periodSize, &dir );
+  if ( result >= 0 ) result = snd_pcm_hw_params_set_periods_near( handle, hw_params, periods, &dir );
+  if ( result >= 0 ) result = snd_pcm_hw_params( handle, hw_params );
+  return result;
 }
 
 bool RtApiAlsa :: probeDeviceOpen( unsigned int device, StreamMode mode, unsigned int channels,
@@ -7118,64 +9934,29 @@ bool RtApiAlsa :: probeDeviceOpen( unsigned int device, StreamMode mode, unsigne
 
   // I'm not using the "plug" interface ... too much inconsistent behavior.
 
-  unsigned nDevices = 0;
-  int result, subdevice, card;
+  int result;
   char name[64];
-  snd_ctl_t *chandle;
 
   if ( options && options->flags & RTAUDIO_ALSA_USE_DEFAULT )
     snprintf(name, sizeof(name), "%s", "default");
   else {
-    // Count cards and devices
-    card = -1;
-    snd_card_next( &card );
-    while ( card >= 0 ) {
-      sprintf( name, "hw:%d", card );
-      result = snd_ctl_open( &chandle, name, SND_CTL_NONBLOCK );
-      if ( result < 0 ) {
-        errorStream_ << "RtApiAlsa::probeDeviceOpen: control open, card = " << card << ", " << snd_strerror( result ) << ".";
-        errorText_ = errorStream_.str();
-        return FAILURE;
-      }
-      subdevice = -1;
-      while( 1 ) {
-        result = snd_ctl_pcm_next_device( chandle, &subdevice );
-        if ( result < 0 ) break;
-        if ( subdevice < 0 ) break;
-        if ( nDevices == device ) {
-          sprintf( name, "hw:%d,%d", card, subdevice );
-          snd_ctl_close( chandle );
-          goto foundDevice;
-        }
-        nDevices++;
-      }
-      snd_ctl_close( chandle );
-      snd_card_next( &card );
-    }
-
-    result = snd_ctl_open( &chandle, "default", SND_CTL_NONBLOCK );
-    if ( result == 0 ) {
-      if ( nDevices == device ) {
-        strcpy( name, "default" );
-        goto foundDevice;
-      }
-      nDevices++;
-    }
-
-    if ( nDevices == 0 ) {
+    updateDeviceList();
+    if ( deviceList_.size() == 0 ) {
       // This should not happen because a check is made before this function is called.
       errorText_ = "RtApiAlsa::probeDeviceOpen: no devices found!";
       return FAILURE;
     }
 
-    if ( device >= nDevices ) {
+    if ( device >= deviceList_.size() ) {
       // This should not happen because a check is made before this function is called.
       errorText_ = "RtApiAlsa::probeDeviceOpen: device ID is invalid!";
       return FAILURE;
     }
-  }
 
- foundDevice:
+    // Open the device by identifier, such that it is the same device
+    // even if the cards were renumbered since the enumeration.
+    snprintf( name, sizeof( name ), "%s", deviceList_[device].identifier.c_str() );
+  }
 
   // The getDeviceInfo() function will not work for a device that is
   // already open.  Thus, we'll probe the system before opening a
@@ -7376,9 +10157,24 @@ bool RtApiAlsa :: probeDeviceOpen( unsigned int device, StreamMode mode, unsigne
     return FAILURE;
   }
 
+  // Determine the buffer (or period) size and the buffer number,
+  // which in ALSA is referred to as the "period".
+  snd_pcm_uframes_t periodSize = *bufferSize;
+  unsigned int periods = 0;
+  if ( options && options->flags & RTAUDIO_MINIMIZE_LATENCY ) periods = 2;
+  if ( options && options->numberOfBuffers > 0 ) periods = options->numberOfBuffers;
+  if ( periods < 2 ) periods = 4; // a fairly safe default value
+  unsigned int targetFrames = getTargetLatencyFrames( options, sampleRate );
+  if ( targetFrames ) findAlsaBuffering( phandle, hw_params, targetFrames, &periodSize, &periods );
+
+  // With adaptive buffering, room is made for twice as many output
+  // periods, of which only the requested number is kept filled.
+  bool adaptive = options && options->flags & RTAUDIO_ADAPTIVE_BUFFERING && mode == OUTPUT;
+  unsigned int filledPeriods = periods;
+  if ( adaptive ) periods *= 2;
+
   // Set the buffer (or period) size.
   int dir = 0;
-  snd_pcm_uframes_t periodSize = *bufferSize;
   result = snd_pcm_hw_params_set_period_size_near( phandle, hw_params, &periodSize, &dir );
   if ( result < 0 ) {
     snd_pcm_close( phandle );
@@ -7388,11 +10184,7 @@ bool RtApiAlsa :: probeDeviceOpen( unsigned int device, StreamMode mode, unsigne
   }
   *bufferSize = periodSize;
 
-  // Set the buffer number, which in ALSA is referred to as the "period".
-  unsigned int periods = 0;
-  if ( options && options->flags & RTAUDIO_MINIMIZE_LATENCY ) periods = 2;
-  if ( options && options->numberOfBuffers > 0 ) periods = options->numberOfBuffers;
-  if ( periods < 2 ) periods = 4; // a fairly safe default value
+  // Set the buffer number.
   result = snd_pcm_hw_params_set_periods_near( phandle, hw_params, &periods, &dir );
   if ( result < 0 ) {
     snd_pcm_close( phandle );
@@ -7400,12 +10192,14 @@ bool RtApiAlsa :: probeDeviceOpen( unsigned int device, StreamMode mode, unsigne
     errorText_ = errorStream_.str();
     return FAILURE;
   }
+  if ( filledPeriods > periods ) filledPeriods = periods;
 
   // If attempting to setup a duplex stream, the bufferSize parameter
-  // MUST be the same in both directions!
+  // MUST be the same in both directions!  Devices that cannot agree
+  // can be bridged with the RTAUDIO_INDEPENDENT_DUPLEX flag.
   if ( stream_.mode == OUTPUT && mode == INPUT && *bufferSize != stream_.bufferSize ) {
     snd_pcm_close( phandle );
-    errorStream_ << "RtApiAlsa::probeDeviceOpen: system error setting buffer size for duplex stream on device (" << name << ").";
+    errorStream_ << "RtApiAlsa::probeDeviceOpen: system error setting buffer size for duplex stream on device (" << name << "), try the RTAUDIO_INDEPENDENT_DUPLEX flag.";
     errorText_ = errorStream_.str();
     return FAILURE;
   }
@@ -7426,25 +10220,16 @@ bool RtApiAlsa :: probeDeviceOpen( unsigned int device, StreamMode mode, unsigne
   snd_pcm_hw_params_dump( hw_params, out );
 #endif
 
-  // Set the software configuration to fill buffers with zeros and prevent device stopping on xruns.
-  snd_pcm_sw_params_t *sw_params = NULL;
-  snd_pcm_sw_params_alloca( &sw_params );
-  snd_pcm_sw_params_current( phandle, sw_params );
-  snd_pcm_sw_params_set_start_threshold( phandle, sw_params, *bufferSize );
-  snd_pcm_sw_params_set_stop_threshold( phandle, sw_params, ULONG_MAX );
-  snd_pcm_sw_params_set_silence_threshold( phandle, sw_params, 0 );
-
-  // The following two settings were suggested by Theo Veenker
-  //snd_pcm_sw_params_set_avail_min( phandle, sw_params, *bufferSize );
-  //snd_pcm_sw_params_set_xfer_align( phandle, sw_params, 1 );
-
-  // here are two options for a fix
-  //snd_pcm_sw_params_set_silence_size( phandle, sw_params, ULONG_MAX );
-  snd_pcm_uframes_t val;
-  snd_pcm_sw_params_get_boundary( sw_params, &val );
-  snd_pcm_sw_params_set_silence_size( phandle, sw_params, val );
+  // Set the software configuration.  The callback thread waits until
+  // the output queue drops below the periods kept filled.
+  snd_pcm_uframes_t availMin;
+  availMin = ( periods - filledPeriods + 1 ) * *bufferSize;
+  result = setAlsaSwParams( phandle, *bufferSize, availMin );
 
-  result = snd_pcm_sw_params( phandle, sw_params );
+  // With the RTAUDIO_PREFILL_OUTPUT flag, an output device is only
+  // started once the periods kept filled have been written.
+  if ( result >= 0 && options && options->flags & RTAUDIO_PREFILL_OUTPUT && mode == OUTPUT )
+    result = setAlsaStartThreshold( phandle, filledPeriods * *bufferSize );
   if ( result < 0 ) {
     snd_pcm_close( phandle );
     errorStream_ << "RtApiAlsa::probeDeviceOpen: error installing software configuration on device (" << name << "), " << snd_strerror( result ) << ".";
@@ -7454,6 +10239,9 @@ bool RtApiAlsa :: probeDeviceOpen( unsigned int device, StreamMode mode, unsigne
 
 #if defined(__RTAUDIO_DEBUG__)
   fprintf(stderr, "\nRtApiAlsa: dump software params after installation:\n\n");
+  snd_pcm_sw_params_t *sw_params = NULL;
+  snd_pcm_sw_params_alloca( &sw_params );
+  snd_pcm_sw_params_current( phandle, sw_params );
   snd_pcm_sw_params_dump( sw_params, out );
 #endif
 
@@ -7491,6 +10279,8 @@ bool RtApiAlsa :: probeDeviceOpen( unsigned int device, StreamMode mode, unsigne
     apiInfo = (AlsaHandle *) stream_.apiHandle;
   }
   apiInfo->handles[mode] = phandle;
+  apiInfo->canPause[mode] = snd_pcm_hw_params_can_pause( hw_params );
+  if ( mode == OUTPUT ) apiInfo->availMin = availMin;
   phandle = 0;
 
   // Allocate necessary internal buffers.
@@ -7526,6 +10316,14 @@ bool RtApiAlsa :: probeDeviceOpen( unsigned int device, StreamMode mode, unsigne
 
   stream_.sampleRate = sampleRate;
   stream_.nBuffers = periods;
+  stream_.channelOffset[mode] = firstChannel;
+  stream_.latency[mode] = *bufferSize * periods;
+  if ( adaptive ) {
+    stream_.adaptive.minimum = filledPeriods;
+    stream_.adaptive.maximum = periods;
+    stream_.adaptive.current = filledPeriods;
+    stream_.latency[mode] = *bufferSize * filledPeriods;
+  }
   stream_.device[mode] = device;
   stream_.state = STREAM_STOPPED;
 
@@ -7534,8 +10332,11 @@ bool RtApiAlsa :: probeDeviceOpen( unsigned int device, StreamMode mode, unsigne
 
   // Setup thread if necessary.
   if ( stream_.mode == OUTPUT && mode == INPUT ) {
-    // We had already set up an output stream.
+    // We had already set up an output stream.  Its output is started
+    // with the input, and prefilled with silence by startStream().
     stream_.mode = DUPLEX;
+    if ( stream_.flags & RTAUDIO_PREFILL_OUTPUT )
+      setAlsaStartThreshold( apiInfo->handles[0], *bufferSize );
     // Link the streams if possible.
     apiInfo->synchronized = false;
     if ( snd_pcm_link( apiInfo->handles[0], apiInfo->handles[1] ) == 0 )
@@ -7551,6 +10352,12 @@ bool RtApiAlsa :: probeDeviceOpen( unsigned int device, StreamMode mode, unsigne
     // Setup callback thread.
     stream_.callbackInfo.object = (void *) this;
 
+    // With manual pumping, the client calls tickStream() from its own thread.
+    if ( options && options->flags & RTAUDIO_MANUAL_PUMP ) {
+      stream_.callbackInfo.manualPump = true;
+      return SUCCESS;
+    }
+
     // Set the thread attributes for joinable and realtime scheduling
     // priority (optional).  The higher priority will only take affect
     // if the program is run as root or suid. Note, under Linux
@@ -7630,9 +10437,11 @@ void RtApiAlsa :: closeStream()
   if ( stream_.state == STREAM_STOPPED ) {
     apiInfo->runnable = true;
     pthread_cond_signal( &apiInfo->runnable_cv );
+    apiInfo->waiter.wake();
   }
   MUTEX_UNLOCK( &stream_.mutex );
-  pthread_join( stream_.callbackInfo.thread, NULL );
+  if ( !stream_.callbackInfo.manualPump )
+    pthread_join( stream_.callbackInfo.thread, NULL );
 
   if ( stream_.state == STREAM_RUNNING ) {
     stream_.state = STREAM_STOPPED;
@@ -7685,17 +10494,42 @@ void RtApiAlsa :: startStream()
   snd_pcm_t **handle = (snd_pcm_t **) apiInfo->handles;
   if ( stream_.mode == OUTPUT || stream_.mode == DUPLEX ) {
     state = snd_pcm_state( handle[0] );
-    if ( state != SND_PCM_STATE_PREPARED ) {
-      result = snd_pcm_prepare( handle[0] );
+    if ( apiInfo->paused[0] ) {
+      apiInfo->paused[0] = false;
+      result = snd_pcm_pause( handle[0], 0 );
       if ( result < 0 ) {
-        errorStream_ << "RtApiAlsa::startStream: error preparing output pcm device, " << snd_strerror( result ) << ".";
+        errorStream_ << "RtApiAlsa::startStream: error resuming output pcm device, " << snd_strerror( result ) << ".";
         errorText_ = errorStream_.str();
         goto unlock;
       }
     }
+    else {
+      if ( state != SND_PCM_STATE_PREPARED ) {
+        result = snd_pcm_prepare( handle[0] );
+        if ( result < 0 ) {
+          errorStream_ << "RtApiAlsa::startStream: error preparing output pcm device, " << snd_strerror( result ) << ".";
+          errorText_ = errorStream_.str();
+          goto unlock;
+        }
+      }
+
+      // The callback of a duplex stream waits for input, so the
+      // periods kept filled are queued as silence in front of it.
+      if ( stream_.mode == DUPLEX && stream_.flags & RTAUDIO_PREFILL_OUTPUT )
+        snd_pcm_forward( handle[0], ( getFilledBuffers() - 1 ) * stream_.bufferSize );
+    }
   }
 
-  if ( ( stream_.mode == INPUT || stream_.mode == DUPLEX ) && !apiInfo->synchronized ) {
+  if ( ( stream_.mode == INPUT || stream_.mode == DUPLEX ) && !apiInfo->synchronized && apiInfo->paused[1] ) {
+    apiInfo->paused[1] = false;
+    result = snd_pcm_pause( handle[1], 0 );
+    if ( result < 0 ) {
+      errorStream_ << "RtApiAlsa::startStream: error resuming input pcm device, " << snd_strerror( result ) << ".";
+      errorText_ = errorStream_.str();
+      goto unlock;
+    }
+  }
+  else if ( ( stream_.mode == INPUT || stream_.mode == DUPLEX ) && !apiInfo->synchronized ) {
     result = snd_pcm_drop(handle[1]); // fix to remove stale data received since device has been open
     state = snd_pcm_state( handle[1] );
     if ( state != SND_PCM_STATE_PREPARED ) {
@@ -7708,109 +10542,475 @@ void RtApiAlsa :: startStream()
     }
   }
 
-  stream_.state = STREAM_RUNNING;
+  apiInfo->pending = 0;
+  stream_.state = STREAM_RUNNING;
+
+ unlock:
+  apiInfo->runnable = true;
+  pthread_cond_signal( &apiInfo->runnable_cv );
+  apiInfo->waiter.wake();
+  MUTEX_UNLOCK( &stream_.mutex );
+
+  if ( result >= 0 ) return;
+  error( RtAudioError::SYSTEM_ERROR );
+}
+
+// Stops a device such that it can be started again without delay: it
+// is paused if the hardware supports it, and otherwise dropped and
+// prepared right away.
+static int stopAlsaWarm( snd_pcm_t *handle, bool canPause, bool *paused )
+{
+  int result;
+  if ( canPause && snd_pcm_state( handle ) == SND_PCM_STATE_RUNNING ) {
+    result = snd_pcm_pause( handle, 1 );
+    if ( result >= 0 ) {
+      *paused = true;
+      return result;
+    }
+  }
+
+  result = snd_pcm_drop( handle );
+  if ( result < 0 ) return result;
+  return snd_pcm_prepare( handle );
+}
+
+void RtApiAlsa :: stopStream()
+{
+  verifyStream();
+  if ( stream_.state == STREAM_STOPPED ) {
+    errorText_ = "RtApiAlsa::stopStream(): the stream is already stopped!";
+    error( RtAudioError::WARNING );
+    return;
+  }
+
+  stream_.state = STREAM_STOPPED;
+  MUTEX_LOCK( &stream_.mutex );
+
+  int result = 0;
+  AlsaHandle *apiInfo = (AlsaHandle *) stream_.apiHandle;
+  snd_pcm_t **handle = (snd_pcm_t **) apiInfo->handles;
+  if ( stream_.mode == OUTPUT || stream_.mode == DUPLEX ) {
+    if ( stream_.flags & RTAUDIO_WARM_STOP )
+      result = stopAlsaWarm( handle[0], apiInfo->canPause[0], &apiInfo->paused[0] );
+    else if ( apiInfo->synchronized ) 
+      result = snd_pcm_drop( handle[0] );
+    else
+      result = snd_pcm_drain( handle[0] );
+    if ( result < 0 ) {
+      errorStream_ << "RtApiAlsa::stopStream: error draining output pcm device, " << snd_strerror( result ) << ".";
+      errorText_ = errorStream_.str();
+      goto unlock;
+    }
+  }
+
+  if ( ( stream_.mode == INPUT || stream_.mode == DUPLEX ) && !apiInfo->synchronized ) {
+    if ( stream_.flags & RTAUDIO_WARM_STOP )
+      result = stopAlsaWarm( handle[1], apiInfo->canPause[1], &apiInfo->paused[1] );
+    else
+      result = snd_pcm_drop( handle[1] );
+    if ( result < 0 ) {
+      errorStream_ << "RtApiAlsa::stopStream: error stopping input pcm device, " << snd_strerror( result ) << ".";
+      errorText_ = errorStream_.str();
+      goto unlock;
+    }
+  }
+
+ unlock:
+  apiInfo->runnable = false; // fixes high CPU usage when stopped
+  MUTEX_UNLOCK( &stream_.mutex );
+
+  if ( result >= 0 ) return;
+  error( RtAudioError::SYSTEM_ERROR );
+}
+
+void RtApiAlsa :: abortStream()
+{
+  verifyStream();
+  if ( stream_.state == STREAM_STOPPED ) {
+    errorText_ = "RtApiAlsa::abortStream(): the stream is already stopped!";
+    error( RtAudioError::WARNING );
+    return;
+  }
+
+  stream_.state = STREAM_STOPPED;
+  MUTEX_LOCK( &stream_.mutex );
+
+  int result = 0;
+  AlsaHandle *apiInfo = (AlsaHandle *) stream_.apiHandle;
+  snd_pcm_t **handle = (snd_pcm_t **) apiInfo->handles;
+  if ( stream_.mode == OUTPUT || stream_.mode == DUPLEX ) {
+    if ( stream_.flags & RTAUDIO_WARM_STOP )
+      result = stopAlsaWarm( handle[0], false, &apiInfo->paused[0] );
+    else
+      result = snd_pcm_drop( handle[0] );
+    if ( result < 0 ) {
+      errorStream_ << "RtApiAlsa::abortStream: error aborting output pcm device, " << snd_strerror( result ) << ".";
+      errorText_ = errorStream_.str();
+      goto unlock;
+    }
+  }
+
+  if ( ( stream_.mode == INPUT || stream_.mode == DUPLEX ) && !apiInfo->synchronized ) {
+    if ( stream_.flags & RTAUDIO_WARM_STOP )
+      result = stopAlsaWarm( handle[1], false, &apiInfo->paused[1] );
+    else
+      result = snd_pcm_drop( handle[1] );
+    if ( result < 0 ) {
+      errorStream_ << "RtApiAlsa::abortStream: error aborting input pcm device, " << snd_strerror( result ) << ".";
+      errorText_ = errorStream_.str();
+      goto unlock;
+    }
+  }
+
+ unlock:
+  apiInfo->runnable = false; // fixes high CPU usage when stopped
+  MUTEX_UNLOCK( &stream_.mutex );
+
+  if ( result >= 0 ) return;
+  error( RtAudioError::SYSTEM_ERROR );
+}
+
+void RtApiAlsa :: tickStream()
+{
+  verifyStream();
+  if ( !stream_.callbackInfo.manualPump ) {
+    errorText_ = "RtApiAlsa::tickStream(): the stream was not opened with the RTAUDIO_MANUAL_PUMP flag!";
+    error( RtAudioError::INVALID_USE );
+    return;
+  }
+
+  // In catch-up mode, a single tick processes all the periods ready.
+  AlsaHandle *apiInfo = (AlsaHandle *) stream_.apiHandle;
+  do callbackEvent();
+  while ( apiInfo->pending > 0 && stream_.state == STREAM_RUNNING );
+}
+
+// Sets the number of free frames for which a blocking write or read,
+// or a poll on the device, waits.
+static int setAlsaAvailMin( snd_pcm_t *handle, snd_pcm_uframes_t frames )
+{
+  snd_pcm_sw_params_t *sw_params;
+  snd_pcm_sw_params_alloca( &sw_params );
+  int result = snd_pcm_sw_params_current( handle, sw_params );
+  if ( result < 0 ) return result;
+  result = snd_pcm_sw_params_set_avail_min( handle, sw_params, frames );
+  if ( result < 0 ) return result;
+  return snd_pcm_sw_params( handle, sw_params );
+}
+
+void RtApiAlsa :: adaptBuffering( int change )
+{
+  AlsaHandle *apiInfo = (AlsaHandle *) stream_.apiHandle;
+  snd_pcm_t *handle = apiInfo->handles[0];
+
+  // An output stream refills or drains to the new level by itself,
+  // but the callback of a duplex stream is paced by the input, so its
+  // output queue is extended with silence or partly discarded.
+  if ( stream_.mode == DUPLEX ) {
+    snd_pcm_uframes_t frames = ( change > 0 ? change : -change ) * stream_.bufferSize;
+    if ( change > 0 ) snd_pcm_forward( handle, frames );
+    else snd_pcm_rewind( handle, frames );
+  }
+
+  apiInfo->availMin = ( stream_.adaptive.maximum - stream_.adaptive.current + 1 ) * stream_.bufferSize;
+  if ( setAlsaAvailMin( handle, apiInfo->availMin ) < 0 ) {
+    errorText_ = "RtApiAlsa::adaptBuffering: error setting the output wakeup threshold.";
+    error( RtAudioError::WARNING );
+  }
+  if ( stream_.mode == OUTPUT && stream_.flags & RTAUDIO_PREFILL_OUTPUT )
+    setAlsaStartThreshold( handle, getFilledBuffers() * stream_.bufferSize );
+  stream_.latency[0] = stream_.adaptive.current * stream_.bufferSize;
+}
+
+// Returns the number of periods that can be processed without
+// blocking, and at least one: the output space beyond the wakeup
+// threshold plus one, and the input frames available, whichever is
+// less for a duplex stream.
+unsigned int RtApiAlsa :: getReadyPeriods( void )
+{
+  AlsaHandle *apiInfo = (AlsaHandle *) stream_.apiHandle;
+  snd_pcm_sframes_t frames;
+  unsigned int periods = 0;
+  if ( stream_.mode == OUTPUT || stream_.mode == DUPLEX ) {
+    frames = snd_pcm_avail( apiInfo->handles[0] );
+    if ( frames < (snd_pcm_sframes_t) apiInfo->availMin ) return 1;
+    periods = ( frames - apiInfo->availMin ) / stream_.bufferSize + 1;
+  }
+
+  if ( stream_.mode == INPUT || stream_.mode == DUPLEX ) {
+    frames = snd_pcm_avail( apiInfo->handles[1] );
+    if ( frames < (snd_pcm_sframes_t) stream_.bufferSize ) return 1;
+    if ( periods == 0 || frames / stream_.bufferSize < periods )
+      periods = frames / stream_.bufferSize;
+  }
+
+  return periods;
+}
+
+bool RtApiAlsa :: reconfigureDevices( unsigned int sampleRate, unsigned int *bufferSize )
+{
+  AlsaHandle *apiInfo = (AlsaHandle *) stream_.apiHandle;
+  snd_pcm_t **handle = (snd_pcm_t **) apiInfo->handles;
+
+  // Wait for the callback thread to park, since its buffers are replaced.
+  MUTEX_LOCK( &stream_.mutex );
+  while ( !stream_.callbackInfo.manualPump && !apiInfo->parked ) {
+    MUTEX_UNLOCK( &stream_.mutex );
+    usleep( 1000 );
+    MUTEX_LOCK( &stream_.mutex );
+  }
+
+  int result = 0;
+  unsigned int rate = sampleRate, periods[2] = { 0, 0 };
+  snd_pcm_uframes_t periodSize = *bufferSize;
+  for ( int i=0; i<2; i++ ) {
+    if ( handle[i] == 0 ) continue;
+
+    // A device paused by a warm stop must be stopped first.
+    snd_pcm_drop( handle[i] );
+    apiInfo->paused[i] = false;
+
+    snd_pcm_uframes_t size = *bufferSize;
+    result = resetAlsaHwParams( handle[i], &rate, &size, &periods[i] );
+    if ( result < 0 ) {
+      errorStream_ << "RtApiAlsa::reconfigureStream: error installing hardware configuration on device, " << snd_strerror( result ) << ".";
+      errorText_ = errorStream_.str();
+      break;
+    }
+
+    // Both directions of a duplex stream must use the same buffer size.
+    if ( i == 1 && handle[0] && size != periodSize ) {
+      errorText_ = "RtApiAlsa::reconfigureStream: system error setting buffer size for duplex stream.";
+      result = -EINVAL;
+      break;
+    }
+    periodSize = size;
+
+    snd_pcm_uframes_t availMin = periodSize;
+    if ( i == 0 && stream_.adaptive.maximum )
+      availMin *= stream_.adaptive.maximum - stream_.adaptive.current + 1;
+    if ( i == 0 ) apiInfo->availMin = availMin;
+    result = setAlsaSwParams( handle[i], periodSize, availMin );
+    if ( result < 0 ) {
+      errorStream_ << "RtApiAlsa::reconfigureStream: error installing software configuration on device, " << snd_strerror( result ) << ".";
+      errorText_ = errorStream_.str();
+      break;
+    }
+  }
+
+  if ( result >= 0 ) {
+    stream_.sampleRate = rate;
+    stream_.bufferSize = periodSize;
+    *bufferSize = periodSize;
+    for ( int i=0; i<2; i++ ) {
+      if ( handle[i] == 0 ) continue;
+      stream_.nBuffers = periods[i];
+      stream_.latency[i] = periodSize * periods[i];
+    }
+    if ( stream_.adaptive.maximum ) stream_.latency[0] = periodSize * stream_.adaptive.current;
+    if ( stream_.mode == OUTPUT && stream_.flags & RTAUDIO_PREFILL_OUTPUT )
+      result = setAlsaStartThreshold( handle[0], getFilledBuffers() * periodSize );
+    if ( result >= 0 && resizeStreamBuffers() == false ) result = -ENOMEM;
+  }
+  MUTEX_UNLOCK( &stream_.mutex );
+
+  if ( result >= 0 ) return SUCCESS;
+
+  // The devices are left without a usable configuration.
+  std::string message = errorText_;
+  closeStream();
+  errorText_ = message;
+  return FAILURE;
+}
+
+bool RtApiAlsa :: armStreamStart( void )
+{
+  AlsaHandle *apiInfo = (AlsaHandle *) stream_.apiHandle;
+  snd_pcm_t **handle = (snd_pcm_t **) apiInfo->handles;
+  int i;
+  for ( i=0; i<2; i++ ) {
+    if ( handle[i] && setAlsaStartThreshold( handle[i], 0 ) < 0 ) break;
+  }
+
+  // With the automatic start disabled, the callback thread prefills
+  // the output buffer and then blocks until the devices are triggered.
+  if ( i == 2 ) {
+    try {
+      startStream();
+    }
+    catch ( RtAudioError & ) {
+      completeStreamStart();
+      throw;
+    }
+    if ( stream_.state == STREAM_RUNNING ) return true;
+  }
+
+  completeStreamStart();
+  return false;
+}
+
+bool RtApiAlsa :: linkStream( RtApi *api )
+{
+  if ( api->getCurrentApi() != RtAudio::LINUX_ALSA ) return false;
+
+  RtApiAlsa *alsa = (RtApiAlsa *) api;
+  AlsaHandle *apiInfo = (AlsaHandle *) stream_.apiHandle;
+  AlsaHandle *otherInfo = (AlsaHandle *) alsa->stream_.apiHandle;
+  snd_pcm_t *reference = apiInfo->handles[0] ? apiInfo->handles[0] : apiInfo->handles[1];
+
+  // A device can only belong to one group, so the devices of a
+  // duplex stream are unlinked from each other first.
+  alsa->unlinkStream();
+  if ( otherInfo->synchronized ) snd_pcm_unlink( otherInfo->handles[1] );
+
+  otherInfo->grouped = true;
+  for ( int i=0; i<2; i++ ) {
+    if ( otherInfo->handles[i] && snd_pcm_link( reference, otherInfo->handles[i] ) < 0 ) {
+      alsa->unlinkStream();
+      return false;
+    }
+  }
+
+  return true;
+}
 
- unlock:
-  apiInfo->runnable = true;
-  pthread_cond_signal( &apiInfo->runnable_cv );
-  MUTEX_UNLOCK( &stream_.mutex );
+void RtApiAlsa :: unlinkStream( void )
+{
+  AlsaHandle *apiInfo = (AlsaHandle *) stream_.apiHandle;
+  if ( !apiInfo->grouped ) return;
 
-  if ( result >= 0 ) return;
-  error( RtAudioError::SYSTEM_ERROR );
+  for ( int i=0; i<2; i++ )
+    if ( apiInfo->handles[i] ) snd_pcm_unlink( apiInfo->handles[i] );
+  if ( apiInfo->synchronized )
+    snd_pcm_link( apiInfo->handles[0], apiInfo->handles[1] );
+  apiInfo->grouped = false;
 }
 
-void RtApiAlsa :: stopStream()
+bool RtApiAlsa :: isStreamPrimed( void )
 {
-  verifyStream();
-  if ( stream_.state == STREAM_STOPPED ) {
-    errorText_ = "RtApiAlsa::stopStream(): the stream is already stopped!";
-    error( RtAudioError::WARNING );
-    return;
-  }
+  // The callback of a duplex stream waits for input before it writes
+  // output, so only output streams are prefilled.
+  if ( stream_.mode != OUTPUT ) return true;
 
-  stream_.state = STREAM_STOPPED;
-  MUTEX_LOCK( &stream_.mutex );
+  AlsaHandle *apiInfo = (AlsaHandle *) stream_.apiHandle;
+  snd_pcm_sframes_t frames = snd_pcm_avail_update( apiInfo->handles[0] );
+  return frames < (snd_pcm_sframes_t) apiInfo->availMin;
+}
 
-  int result = 0;
+void RtApiAlsa :: triggerStreamStart( void )
+{
   AlsaHandle *apiInfo = (AlsaHandle *) stream_.apiHandle;
   snd_pcm_t **handle = (snd_pcm_t **) apiInfo->handles;
-  if ( stream_.mode == OUTPUT || stream_.mode == DUPLEX ) {
-    if ( apiInfo->synchronized ) 
-      result = snd_pcm_drop( handle[0] );
-    else
-      result = snd_pcm_drain( handle[0] );
-    if ( result < 0 ) {
-      errorStream_ << "RtApiAlsa::stopStream: error draining output pcm device, " << snd_strerror( result ) << ".";
-      errorText_ = errorStream_.str();
-      goto unlock;
-    }
-  }
-
-  if ( ( stream_.mode == INPUT || stream_.mode == DUPLEX ) && !apiInfo->synchronized ) {
-    result = snd_pcm_drop( handle[1] );
+  for ( int i=0; i<2; i++ ) {
+    if ( handle[i] == 0 || snd_pcm_state( handle[i] ) != SND_PCM_STATE_PREPARED ) continue;
+    int result = snd_pcm_start( handle[i] );
     if ( result < 0 ) {
-      errorStream_ << "RtApiAlsa::stopStream: error stopping input pcm device, " << snd_strerror( result ) << ".";
+      errorStream_ << "RtApiAlsa::triggerStreamStart: error starting pcm device, " << snd_strerror( result ) << ".";
       errorText_ = errorStream_.str();
-      goto unlock;
+      error( RtAudioError::SYSTEM_ERROR );
+      return;
     }
   }
+}
 
- unlock:
-  apiInfo->runnable = false; // fixes high CPU usage when stopped
-  MUTEX_UNLOCK( &stream_.mutex );
+void RtApiAlsa :: completeStreamStart( void )
+{
+  AlsaHandle *apiInfo = (AlsaHandle *) stream_.apiHandle;
+  snd_pcm_t **handle = (snd_pcm_t **) apiInfo->handles;
+  snd_pcm_status_t *status;
+  snd_pcm_status_alloca( &status );
+  snd_htimestamp_t trigger, now;
 
-  if ( result >= 0 ) return;
-  error( RtAudioError::SYSTEM_ERROR );
+  // Restore the automatic start, which is used after xrun recovery,
+  // and convert the device trigger timestamps to the monotonic clock.
+  stream_.startTime = 0.0;
+  for ( int i=0; i<2; i++ ) {
+    if ( handle[i] == 0 ) continue;
+    if ( i == 0 && stream_.mode == OUTPUT && stream_.flags & RTAUDIO_PREFILL_OUTPUT )
+      setAlsaStartThreshold( handle[i], getFilledBuffers() * stream_.bufferSize );
+    else
+      setAlsaStartThreshold( handle[i], stream_.bufferSize );
+    if ( snd_pcm_status( handle[i], status ) < 0 ) continue;
+    double time = getMonotonicTime();
+    snd_pcm_status_get_trigger_htstamp( status, &trigger );
+    snd_pcm_status_get_htstamp( status, &now );
+    if ( trigger.tv_sec == 0 && trigger.tv_nsec == 0 ) continue;
+    time -= ( now.tv_sec - trigger.tv_sec ) + ( now.tv_nsec - trigger.tv_nsec ) * 1e-9;
+    if ( stream_.startTime == 0.0 || time < stream_.startTime ) stream_.startTime = time;
+  }
 }
 
-void RtApiAlsa :: abortStream()
+unsigned int RtApiAlsa :: getStreamPollDescriptors( struct pollfd *pfds, unsigned int space )
 {
-  verifyStream();
-  if ( stream_.state == STREAM_STOPPED ) {
-    errorText_ = "RtApiAlsa::abortStream(): the stream is already stopped!";
-    error( RtAudioError::WARNING );
-    return;
+  if ( stream_.state == STREAM_CLOSED ) return 0;
+
+  // Without a descriptor array, return the number of descriptors needed.
+  AlsaHandle *apiInfo = (AlsaHandle *) stream_.apiHandle;
+  unsigned int count = 0;
+  int result;
+  for ( int i=0; i<2; i++ ) {
+    if ( apiInfo->handles[i] == 0 ) continue;
+    if ( pfds == NULL )
+      result = snd_pcm_poll_descriptors_count( apiInfo->handles[i] );
+    else
+      result = snd_pcm_poll_descriptors( apiInfo->handles[i], pfds + count, space - count );
+    if ( result > 0 ) count += result;
   }
 
-  stream_.state = STREAM_STOPPED;
-  MUTEX_LOCK( &stream_.mutex );
+  return count;
+}
 
-  int result = 0;
+bool RtApiAlsa :: isStreamReady( void )
+{
+  if ( stream_.state != STREAM_RUNNING ) return false;
+
+  // Errors and xruns are reported as ready so that callbackEvent()
+  // can recover the device.
   AlsaHandle *apiInfo = (AlsaHandle *) stream_.apiHandle;
   snd_pcm_t **handle = (snd_pcm_t **) apiInfo->handles;
+  snd_pcm_sframes_t frames;
   if ( stream_.mode == OUTPUT || stream_.mode == DUPLEX ) {
-    result = snd_pcm_drop( handle[0] );
-    if ( result < 0 ) {
-      errorStream_ << "RtApiAlsa::abortStream: error aborting output pcm device, " << snd_strerror( result ) << ".";
-      errorText_ = errorStream_.str();
-      goto unlock;
-    }
+    frames = snd_pcm_avail_update( handle[0] );
+    if ( frames >= 0 && frames < (snd_pcm_sframes_t) apiInfo->availMin ) return false;
   }
 
-  if ( ( stream_.mode == INPUT || stream_.mode == DUPLEX ) && !apiInfo->synchronized ) {
-    result = snd_pcm_drop( handle[1] );
-    if ( result < 0 ) {
-      errorStream_ << "RtApiAlsa::abortStream: error aborting input pcm device, " << snd_strerror( result ) << ".";
-      errorText_ = errorStream_.str();
-      goto unlock;
-    }
+  if ( stream_.mode == INPUT || stream_.mode == DUPLEX ) {
+    // A prepared capture device is only started by the first read.
+    if ( snd_pcm_state( handle[1] ) == SND_PCM_STATE_PREPARED ) return true;
+    frames = snd_pcm_avail_update( handle[1] );
+    if ( frames >= 0 && frames < (snd_pcm_sframes_t) stream_.bufferSize ) return false;
   }
 
- unlock:
-  apiInfo->runnable = false; // fixes high CPU usage when stopped
-  MUTEX_UNLOCK( &stream_.mutex );
-
-  if ( result >= 0 ) return;
-  error( RtAudioError::SYSTEM_ERROR );
+  return true;
 }
 
+// The longest time that the callback thread of a stream opened with
+// the RTAUDIO_WARM_STOP flag waits before checking its state again.
+static const double ALSA_WARM_WAIT_TIMEOUT = 0.1;
+
 void RtApiAlsa :: callbackEvent()
 {
   AlsaHandle *apiInfo = (AlsaHandle *) stream_.apiHandle;
   if ( stream_.state == STREAM_STOPPED ) {
+    // A manually pumped stream has no thread to park.
+    if ( stream_.callbackInfo.manualPump ) return;
+
+    // After a warm stop, the thread waits on a futex rather than on the
+    // stream mutex and condition variable, to resume without delay.
+    if ( stream_.flags & RTAUDIO_WARM_STOP ) {
+      int sequence = apiInfo->waiter.sequence();
+      apiInfo->parked = true;
+      if ( stream_.state == STREAM_STOPPED && stream_.callbackInfo.isRunning )
+        apiInfo->waiter.wait( sequence, ALSA_WARM_WAIT_TIMEOUT );
+      apiInfo->parked = false;
+      return;
+    }
+
     MUTEX_LOCK( &stream_.mutex );
+    apiInfo->parked = true;
     while ( !apiInfo->runnable )
       pthread_cond_wait( &apiInfo->runnable_cv, &stream_.mutex );
+    apiInfo->parked = false;
 
     if ( stream_.state != STREAM_RUNNING ) {
       MUTEX_UNLOCK( &stream_.mutex );
@@ -7825,6 +11025,13 @@ void RtApiAlsa :: callbackEvent()
     return;
   }
 
+  // In catch-up mode, the periods found ready on a wakeup are all
+  // processed back-to-back, without querying the latency in between.
+  if ( stream_.flags & RTAUDIO_CATCH_UP && apiInfo->pending == 0 ) {
+    apiInfo->pending = getReadyPeriods();
+    if ( apiInfo->pending > 1 ) stream_.stats.catchUps++;
+  }
+
   int doStopStream = 0;
   RtAudioCallback callback = (RtAudioCallback) stream_.callbackInfo.callback;
   double streamTime = getStreamTime();
@@ -7837,6 +11044,7 @@ void RtApiAlsa :: callbackEvent()
     status |= RTAUDIO_INPUT_OVERFLOW;
     apiInfo->xrun[1] = false;
   }
+  int change = updateStreamStats( status );
   doStopStream = callback( stream_.userBuffer[0], stream_.userBuffer[1],
                            stream_.bufferSize, streamTime, status, stream_.callbackInfo.userData );
 
@@ -7917,8 +11125,10 @@ void RtApiAlsa :: callbackEvent()
       convertBuffer( stream_.userBuffer[1], stream_.deviceBuffer, stream_.convertInfo[1] );
 
     // Check stream latency
-    result = snd_pcm_delay( handle[1], &frames );
-    if ( result == 0 && frames > 0 ) stream_.latency[1] = frames;
+    if ( apiInfo->pending <= 1 ) {
+      result = snd_pcm_delay( handle[1], &frames );
+      if ( result == 0 && frames > 0 ) stream_.latency[1] = frames;
+    }
   }
 
  tryOutput:
@@ -7964,8 +11174,12 @@ void RtApiAlsa :: callbackEvent()
             errorStream_ << "RtApiAlsa::callbackEvent: error preparing device after underrun, " << snd_strerror( result ) << ".";
             errorText_ = errorStream_.str();
           }
-          else
+          else {
             errorText_ =  "RtApiAlsa::callbackEvent: audio write error, underrun.";
+            // Restore the periods kept filled in front of the next write.
+            if ( ( stream_.adaptive.maximum || stream_.flags & RTAUDIO_PREFILL_OUTPUT ) && stream_.mode == DUPLEX )
+              snd_pcm_forward( handle[0], ( getFilledBuffers() - 1 ) * stream_.bufferSize );
+          }
         }
         else {
           errorStream_ << "RtApiAlsa::callbackEvent: error, current state is " << snd_pcm_state_name( state ) << ", " << snd_strerror( result ) << ".";
@@ -7981,11 +11195,15 @@ void RtApiAlsa :: callbackEvent()
     }
 
     // Check stream latency
-    result = snd_pcm_delay( handle[0], &frames );
-    if ( result == 0 && frames > 0 ) stream_.latency[0] = frames;
+    if ( apiInfo->pending <= 1 ) {
+      result = snd_pcm_delay( handle[0], &frames );
+      if ( result == 0 && frames > 0 ) stream_.latency[0] = frames;
+    }
   }
 
  unlock:
+  if ( apiInfo->pending > 0 ) apiInfo->pending--;
+  if ( change && stream_.state == STREAM_RUNNING ) adaptBuffering( change );
   MUTEX_UNLOCK( &stream_.mutex );
 
   RtApi::tickStreamTime();
@@ -8014,10 +11232,15 @@ static void *alsaCallbackHandler( void *ptr )
   pthread_exit( NULL );
 }
 
+#if defined(__RTAUDIO_PLUGIN_ALSA__)
+// The entry point of the ALSA plugin (see createPluginApi()).
+extern "C" RTAUDIO_DLL_PUBLIC RtApi *rtaudio_create_api( void ) { return new RtApiAlsa(); }
+#endif
+
 //******************** End of __LINUX_ALSA__ *********************//
 #endif
 
-#if defined(__LINUX_PULSE__)
+#if defined(__LINUX_PULSE__) && ( !defined(__RTAUDIO_PLUGINS__) || defined(__RTAUDIO_PLUGIN_PULSE__) )
 
 // Code written by Peter Meerwald, pmeerw@pmeerw.net
 // and Tristan Matthews.
@@ -8107,7 +11330,8 @@ void RtApiPulse::closeStream( void )
     }
     MUTEX_UNLOCK( &stream_.mutex );
 
-    pthread_join( pah->thread, 0 );
+    if ( !stream_.callbackInfo.manualPump )
+      pthread_join( pah->thread, 0 );
     if ( pah->s_play ) {
       pa_simple_flush( pah->s_play, NULL );
       pa_simple_free( pah->s_play );
@@ -8133,11 +11357,30 @@ void RtApiPulse::closeStream( void )
   stream_.mode = UNINITIALIZED;
 }
 
+void RtApiPulse::tickStream( void )
+{
+  if ( stream_.state == STREAM_CLOSED ) {
+    errorText_ = "RtApiPulse::tickStream(): the stream is not open!";
+    error( RtAudioError::INVALID_USE );
+    return;
+  }
+  if ( !stream_.callbackInfo.manualPump ) {
+    errorText_ = "RtApiPulse::tickStream(): the stream was not opened with the RTAUDIO_MANUAL_PUMP flag!";
+    error( RtAudioError::INVALID_USE );
+    return;
+  }
+
+  callbackEvent();
+}
+
 void RtApiPulse::callbackEvent( void )
 {
   PulseAudioHandle *pah = static_cast<PulseAudioHandle *>( stream_.apiHandle );
 
   if ( stream_.state == STREAM_STOPPED ) {
+    // A manually pumped stream has no thread to park.
+    if ( stream_.callbackInfo.manualPump ) return;
+
     MUTEX_LOCK( &stream_.mutex );
     while ( !pah->runnable )
       pthread_cond_wait( &pah->runnable_cv, &stream_.mutex );
@@ -8159,6 +11402,7 @@ void RtApiPulse::callbackEvent( void )
   RtAudioCallback callback = (RtAudioCallback) stream_.callbackInfo.callback;
   double streamTime = getStreamTime();
   RtAudioStreamStatus status = 0;
+  updateStreamStats( status );
   int doStopStream = callback( stream_.userBuffer[OUTPUT], stream_.userBuffer[INPUT],
                                stream_.bufferSize, streamTime, status,
                                stream_.callbackInfo.userData );
@@ -8367,6 +11611,14 @@ bool RtApiPulse::probeDeviceOpen( unsigned int device, StreamMode mode,
     ss.format = PA_SAMPLE_FLOAT32LE;
   }
 
+  // For a latency target, the server buffers the whole target and the
+  // stream exchanges half of it at a time.
+  unsigned int targetFrames = getTargetLatencyFrames( options, sampleRate );
+  if ( targetFrames ) {
+    *bufferSize = targetFrames > 1 ? targetFrames / 2 : 1;
+    stream_.latency[mode] = targetFrames;
+  }
+
   // Set other stream parameters.
   if ( options && options->flags & RTAUDIO_NONINTERLEAVED ) stream_.userInterleaved = false;
   else stream_.userInterleaved = true;
@@ -8443,6 +11695,9 @@ bool RtApiPulse::probeDeviceOpen( unsigned int device, StreamMode mode,
     pa_buffer_attr buffer_attr;
     buffer_attr.fragsize = bufferBytes;
     buffer_attr.maxlength = -1;
+    if ( targetFrames )
+      // Let the server deliver the input no later than the target.
+      buffer_attr.fragsize = targetFrames * stream_.nDeviceChannels[mode] * formatBytes( stream_.deviceFormat[mode] );
 
     pah->s_rec = pa_simple_new( NULL, streamName.c_str(), PA_STREAM_RECORD, NULL, "Record", &ss, NULL, &buffer_attr, &error );
     if ( !pah->s_rec ) {
@@ -8451,7 +11706,18 @@ bool RtApiPulse::probeDeviceOpen( unsigned int device, StreamMode mode,
     }
     break;
   case OUTPUT:
-    pah->s_play = pa_simple_new( NULL, streamName.c_str(), PA_STREAM_PLAYBACK, NULL, "Playback", &ss, NULL, NULL, &error );
+    if ( targetFrames ) {
+      // Let the server keep no more than the target in its buffer.
+      pa_buffer_attr target_attr;
+      target_attr.maxlength = (uint32_t) -1;
+      target_attr.tlength = targetFrames * stream_.nDeviceChannels[mode] * formatBytes( stream_.deviceFormat[mode] );
+      target_attr.prebuf = (uint32_t) -1;
+      target_attr.minreq = (uint32_t) -1;
+      target_attr.fragsize = (uint32_t) -1;
+      pah->s_play = pa_simple_new( NULL, streamName.c_str(), PA_STREAM_PLAYBACK, NULL, "Playback", &ss, NULL, &target_attr, &error );
+    }
+    else
+      pah->s_play = pa_simple_new( NULL, streamName.c_str(), PA_STREAM_PLAYBACK, NULL, "Playback", &ss, NULL, NULL, &error );
     if ( !pah->s_play ) {
       errorText_ = "RtApiPulse::probeDeviceOpen: error connecting output to PulseAudio server.";
       goto error;
@@ -8471,7 +11737,10 @@ bool RtApiPulse::probeDeviceOpen( unsigned int device, StreamMode mode,
   if ( !stream_.callbackInfo.isRunning ) {
     stream_.callbackInfo.object = this;
     stream_.callbackInfo.isRunning = true;
-    if ( pthread_create( &pah->thread, NULL, pulseaudio_callback, (void *)&stream_.callbackInfo) != 0 ) {
+    if ( options && options->flags & RTAUDIO_MANUAL_PUMP )
+      // The client calls tickStream() from its own thread.
+      stream_.callbackInfo.manualPump = true;
+    else if ( pthread_create( &pah->thread, NULL, pulseaudio_callback, (void *)&stream_.callbackInfo) != 0 ) {
       errorText_ = "RtApiPulse::probeDeviceOpen: error creating thread.";
       goto error;
     }
@@ -8502,10 +11771,15 @@ bool RtApiPulse::probeDeviceOpen( unsigned int device, StreamMode mode,
   return FAILURE;
 }
 
+#if defined(__RTAUDIO_PLUGIN_PULSE__)
+// The entry point of the PulseAudio plugin (see createPluginApi()).
+extern "C" RTAUDIO_DLL_PUBLIC RtApi *rtaudio_create_api( void ) { return new RtApiPulse(); }
+#endif
+
 //******************** End of __LINUX_PULSE__ *********************//
 #endif
 
-#if defined(__LINUX_OSS__)
+#if defined(__LINUX_OSS__) && !defined(__RTAUDIO_PLUGIN_ONLY__)
 
 #include <unistd.h>
 #include <sys/ioctl.h>
@@ -8523,10 +11797,13 @@ struct OssHandle {
   int id[2];    // device ids
   bool xrun[2];
   bool triggered;
+  unsigned int prefilled; // Output buffers written before the trigger.
   pthread_cond_t runnable;
+  bool parked;  // The callback thread waits for the stream to start.
+  std::vector<char> silence; // One buffer written ahead of the output.
 
   OssHandle()
-    :triggered(false) { id[0] = 0; id[1] = 0; xrun[0] = false; xrun[1] = false; }
+    :triggered(false), prefilled(0), parked(false) { id[0] = 0; id[1] = 0; xrun[0] = false; xrun[1] = false; }
 };
 
 RtApiOss :: RtApiOss()
@@ -8596,10 +11873,45 @@ RtAudio::DeviceInfo RtApiOss :: getDeviceInfo( unsigned int device )
     return info;
   }
 
+  info = probeDeviceInfo( mixerfd, device );
+  close( mixerfd );
+  return info;
+}
+
+std::vector<RtAudio::DeviceInfo> RtApiOss :: getDevices( bool /*probeCapabilities*/ )
+{
+  std::vector<RtAudio::DeviceInfo> devices;
+  int mixerfd = open( "/dev/mixer", O_RDWR, 0 );
+  if ( mixerfd == -1 ) {
+    errorText_ = "RtApiOss::getDevices: error opening '/dev/mixer'.";
+    error( RtAudioError::WARNING );
+    return devices;
+  }
+
+  oss_sysinfo sysinfo;
+  if ( ioctl( mixerfd, SNDCTL_SYSINFO, &sysinfo ) == -1 ) {
+    close( mixerfd );
+    errorText_ = "RtApiOss::getDevices: error getting sysinfo, OSS version >= 4.0 is required.";
+    error( RtAudioError::WARNING );
+    return devices;
+  }
+
+  // All the devices are queried through the same mixer descriptor.
+  devices.resize( sysinfo.numaudios );
+  for ( unsigned int i=0; i<devices.size(); i++ )
+    devices[i] = probeDeviceInfo( mixerfd, i );
+  close( mixerfd );
+  return devices;
+}
+
+RtAudio::DeviceInfo RtApiOss :: probeDeviceInfo( int mixerfd, unsigned int device )
+{
+  RtAudio::DeviceInfo info;
+  info.probed = false;
+
   oss_audioinfo ainfo;
   ainfo.dev = device;
-  result = ioctl( mixerfd, SNDCTL_AUDIOINFO, &ainfo );
-  close( mixerfd );
+  int result = ioctl( mixerfd, SNDCTL_AUDIOINFO, &ainfo );
   if ( result == -1 ) {
     errorStream_ << "RtApiOss::getDeviceInfo: error getting device (" << ainfo.name << ") info.";
     errorText_ = errorStream_.str();
@@ -8607,6 +11919,9 @@ RtAudio::DeviceInfo RtApiOss :: getDeviceInfo( unsigned int device )
     return info;
   }
 
+  // The handle is unique for the device, unlike its number.
+  info.identifier = ainfo.handle[0] ? ainfo.handle : ainfo.devnode;
+
   // Probe channels
   if ( ainfo.caps & PCM_CAP_OUTPUT ) info.outputChannels = ainfo.max_channels;
   if ( ainfo.caps & PCM_CAP_INPUT ) info.inputChannels = ainfo.max_channels;
@@ -8640,6 +11955,10 @@ RtAudio::DeviceInfo RtApiOss :: getDeviceInfo( unsigned int device )
 
   // Probe the supported sample rates.
   info.sampleRates.clear();
+  if ( ainfo.min_rate > 0 && ainfo.max_rate >= ainfo.min_rate ) {
+    info.minSampleRate = ainfo.min_rate;
+    info.maxSampleRate = ainfo.max_rate;
+  }
   if ( ainfo.nrates ) {
     for ( unsigned int i=0; i<ainfo.nrates; i++ ) {
       for ( unsigned int k=0; k<MAX_SAMPLE_RATES; k++ ) {
@@ -8928,6 +12247,24 @@ bool RtApiOss :: probeDeviceOpen( unsigned int device, StreamMode mode, unsigned
   if ( options ) buffers = options->numberOfBuffers;
   if ( options && options->flags & RTAUDIO_MINIMIZE_LATENCY ) buffers = 2;
   if ( buffers < 2 ) buffers = 3;
+
+  // For a latency target, the largest fragment that fits twice gives
+  // the fewest wakeups, since fragments are powers of two bytes, and
+  // the remaining room is used for more fragments.
+  unsigned int targetFrames = getTargetLatencyFrames( options, sampleRate );
+  if ( targetFrames ) {
+    int targetBytes = targetFrames * formatBytes( stream_.deviceFormat[mode] ) * deviceChannels;
+    ossBufferBytes = 16;
+    while ( ossBufferBytes * 4 <= targetBytes ) ossBufferBytes *= 2;
+    buffers = targetBytes / ossBufferBytes;
+    if ( buffers < 2 ) buffers = 2;
+  }
+
+  // With adaptive buffering, room is made for twice as many output
+  // fragments, of which only the requested number is kept filled.
+  bool adaptive = options && options->flags & RTAUDIO_ADAPTIVE_BUFFERING && mode == OUTPUT;
+  int filledBuffers = buffers;
+  if ( adaptive ) buffers *= 2;
   temp = ((int) buffers << 16) + (int)( log10( (double)ossBufferBytes ) / log10( 2.0 ) );
   result = ioctl( fd, SNDCTL_DSP_SETFRAGMENT, &temp );
   if ( result == -1 ) {
@@ -8941,6 +12278,14 @@ bool RtApiOss :: probeDeviceOpen( unsigned int device, StreamMode mode, unsigned
   // Save buffer size (in sample frames).
   *bufferSize = ossBufferBytes / ( formatBytes(stream_.deviceFormat[mode]) * deviceChannels );
   stream_.bufferSize = *bufferSize;
+  stream_.channelOffset[mode] = firstChannel;
+  stream_.latency[mode] = *bufferSize * buffers;
+  if ( adaptive ) {
+    stream_.adaptive.minimum = filledBuffers;
+    stream_.adaptive.maximum = buffers;
+    stream_.adaptive.current = filledBuffers;
+    stream_.latency[mode] = *bufferSize * filledBuffers;
+  }
 
   // Set the sample rate.
   int srate = sampleRate;
@@ -9004,6 +12349,8 @@ bool RtApiOss :: probeDeviceOpen( unsigned int device, StreamMode mode, unsigned
     handle = (OssHandle *) stream_.apiHandle;
   }
   handle->id[mode] = fd;
+  if ( adaptive || ( stream_.flags & RTAUDIO_PREFILL_OUTPUT && mode == OUTPUT ) )
+    handle->silence.assign( ossBufferBytes, 0 );
 
   // Allocate necessary internal buffers.
   unsigned long bufferBytes;
@@ -9054,6 +12401,12 @@ bool RtApiOss :: probeDeviceOpen( unsigned int device, StreamMode mode, unsigned
     // Setup callback thread.
     stream_.callbackInfo.object = (void *) this;
 
+    // With manual pumping, the client calls tickStream() from its own thread.
+    if ( options && options->flags & RTAUDIO_MANUAL_PUMP ) {
+      stream_.callbackInfo.manualPump = true;
+      return SUCCESS;
+    }
+
     // Set the thread attributes for joinable and realtime scheduling
     // priority.  The higher priority will only take affect if the
     // program is run as root or suid.
@@ -9128,7 +12481,8 @@ void RtApiOss :: closeStream()
   if ( stream_.state == STREAM_STOPPED )
     pthread_cond_signal( &handle->runnable );
   MUTEX_UNLOCK( &stream_.mutex );
-  pthread_join( stream_.callbackInfo.thread, NULL );
+  if ( !stream_.callbackInfo.manualPump )
+    pthread_join( stream_.callbackInfo.thread, NULL );
 
   if ( stream_.state == STREAM_RUNNING ) {
     if ( stream_.mode == OUTPUT || stream_.mode == DUPLEX )
@@ -9221,6 +12575,13 @@ void RtApiOss :: stopStream()
       format = stream_.userFormat;
     }
 
+    // An output still being prefilled is triggered first, such that
+    // the writes below cannot block.
+    if ( handle->prefilled > 0 ) {
+      int trig = PCM_ENABLE_OUTPUT;
+      ioctl( handle->id[0], SNDCTL_DSP_SETTRIGGER, &trig );
+    }
+
     memset( buffer, 0, samples * formatBytes(format) );
     for ( unsigned int i=0; i<stream_.nBuffers+1; i++ ) {
       result = write( handle->id[0], buffer, samples * formatBytes(format) );
@@ -9237,6 +12598,7 @@ void RtApiOss :: stopStream()
       goto unlock;
     }
     handle->triggered = false;
+    handle->prefilled = 0;
   }
 
   if ( stream_.mode == INPUT || ( stream_.mode == DUPLEX && handle->id[0] != handle->id[1] ) ) {
@@ -9283,6 +12645,7 @@ void RtApiOss :: abortStream()
       goto unlock;
     }
     handle->triggered = false;
+    handle->prefilled = 0;
   }
 
   if ( stream_.mode == INPUT || ( stream_.mode == DUPLEX && handle->id[0] != handle->id[1] ) ) {
@@ -9302,12 +12665,180 @@ void RtApiOss :: abortStream()
   error( RtAudioError::SYSTEM_ERROR );
 }
 
+void RtApiOss :: tickStream()
+{
+  verifyStream();
+  if ( !stream_.callbackInfo.manualPump ) {
+    errorText_ = "RtApiOss::tickStream(): the stream was not opened with the RTAUDIO_MANUAL_PUMP flag!";
+    error( RtAudioError::INVALID_USE );
+    return;
+  }
+
+  callbackEvent();
+}
+
+unsigned int RtApiOss :: getStreamPollDescriptors( struct pollfd *pfds, unsigned int space )
+{
+  if ( stream_.state == STREAM_CLOSED ) return 0;
+
+  // Without a descriptor array, return the number of descriptors needed.
+  OssHandle *handle = (OssHandle *) stream_.apiHandle;
+  bool shared = ( stream_.mode == DUPLEX && handle->id[0] == handle->id[1] );
+  unsigned int count = 0;
+  if ( stream_.mode == OUTPUT || stream_.mode == DUPLEX ) {
+    if ( pfds ) {
+      if ( count == space ) return count;
+      pfds[count].fd = handle->id[0];
+      pfds[count].events = shared ? POLLOUT | POLLIN : POLLOUT;
+      pfds[count].revents = 0;
+    }
+    count++;
+  }
+
+  if ( ( stream_.mode == INPUT || stream_.mode == DUPLEX ) && !shared ) {
+    // Polling an input device also triggers recording.
+    if ( pfds ) {
+      if ( count == space ) return count;
+      pfds[count].fd = handle->id[1];
+      pfds[count].events = POLLIN;
+      pfds[count].revents = 0;
+    }
+    count++;
+  }
+
+  return count;
+}
+
+bool RtApiOss :: isStreamReady( void )
+{
+  if ( stream_.state != STREAM_RUNNING ) return false;
+
+  // A duplex device is only triggered by the first callbackEvent().
+  OssHandle *handle = (OssHandle *) stream_.apiHandle;
+  if ( stream_.mode == DUPLEX && handle->triggered == false ) return true;
+
+  audio_buf_info bufferInfo;
+  int bytes;
+  if ( stream_.mode == OUTPUT || stream_.mode == DUPLEX ) {
+    bytes = stream_.bufferSize * stream_.nDeviceChannels[0] * formatBytes( stream_.deviceFormat[0] );
+    if ( ioctl( handle->id[0], SNDCTL_DSP_GETOSPACE, &bufferInfo ) != -1 && bufferInfo.bytes < bytes )
+      return false;
+  }
+
+  if ( stream_.mode == INPUT || stream_.mode == DUPLEX ) {
+    bytes = stream_.bufferSize * stream_.nDeviceChannels[1] * formatBytes( stream_.deviceFormat[1] );
+    if ( ioctl( handle->id[1], SNDCTL_DSP_GETISPACE, &bufferInfo ) != -1 && bufferInfo.bytes < bytes )
+      return false;
+  }
+
+  return true;
+}
+
+bool RtApiOss :: reconfigureDevices( unsigned int sampleRate, unsigned int *bufferSize )
+{
+  OssHandle *handle = (OssHandle *) stream_.apiHandle;
+
+  // Wait for the callback thread to park, since its buffers are replaced.
+  MUTEX_LOCK( &stream_.mutex );
+  while ( !stream_.callbackInfo.manualPump && !handle->parked ) {
+    MUTEX_UNLOCK( &stream_.mutex );
+    usleep( 1000 );
+    MUTEX_LOCK( &stream_.mutex );
+  }
+
+  // The fragment settings can only be changed while the devices are
+  // halted.  As in probeDeviceOpen(), the fragment size is a power of
+  // two bytes.
+  bool result = SUCCESS;
+  unsigned int size = *bufferSize;
+  for ( int i=0; i<2; i++ ) {
+    if ( stream_.mode == ( i == 0 ? INPUT : OUTPUT ) ) continue;
+    if ( i == 1 && stream_.mode == DUPLEX && handle->id[1] == handle->id[0] ) continue;
+
+    int fd = handle->id[i];
+    int frameBytes = formatBytes( stream_.deviceFormat[i] ) * stream_.nDeviceChannels[i];
+    int ossBufferBytes = *bufferSize * frameBytes;
+    if ( ossBufferBytes < 16 ) ossBufferBytes = 16;
+    int temp = ((int) stream_.nBuffers << 16) + (int)( log10( (double)ossBufferBytes ) / log10( 2.0 ) );
+    int srate = sampleRate;
+    if ( ioctl( fd, SNDCTL_DSP_HALT, 0 ) == -1 || ioctl( fd, SNDCTL_DSP_SETFRAGMENT, &temp ) == -1 ) {
+      errorStream_ << "RtApiOss::reconfigureStream: error setting buffer size on device (" << stream_.device[i] << ").";
+      errorText_ = errorStream_.str();
+      result = FAILURE;
+      break;
+    }
+    if ( ioctl( fd, SNDCTL_DSP_SPEED, &srate ) == -1 || abs( srate - (int)sampleRate ) > 100 ) {
+      errorStream_ << "RtApiOss::reconfigureStream: error setting sample rate (" << sampleRate << ") on device (" << stream_.device[i] << ").";
+      errorText_ = errorStream_.str();
+      result = FAILURE;
+      break;
+    }
+    size = ossBufferBytes / frameBytes;
+    if ( i == 0 && ( stream_.adaptive.maximum || stream_.flags & RTAUDIO_PREFILL_OUTPUT ) )
+      handle->silence.assign( ossBufferBytes, 0 );
+  }
+
+  if ( result == SUCCESS ) {
+    stream_.sampleRate = sampleRate;
+    stream_.bufferSize = size;
+    *bufferSize = size;
+    for ( int i=0; i<2; i++ )
+      if ( stream_.mode == DUPLEX || stream_.mode == ( i == 0 ? OUTPUT : INPUT ) )
+        stream_.latency[i] = size * stream_.nBuffers;
+    if ( stream_.adaptive.maximum ) stream_.latency[0] = size * stream_.adaptive.current;
+    handle->triggered = false;
+    handle->prefilled = 0;
+    result = resizeStreamBuffers();
+  }
+  MUTEX_UNLOCK( &stream_.mutex );
+
+  if ( result == SUCCESS ) return SUCCESS;
+
+  // The devices are left without a usable configuration.
+  std::string message = errorText_;
+  closeStream();
+  errorText_ = message;
+  return FAILURE;
+}
+
+// Applies the adaptive buffering before the output of a callback is
+// written.  An output stream waits until the device has played down
+// to the buffers kept filled.  The callback of a duplex stream is
+// paced by the input, so silence is written ahead of the output to
+// raise its latency, and false is returned to drop the output of this
+// callback to lower it.
+bool RtApiOss :: adaptBuffering( int change )
+{
+  OssHandle *handle = (OssHandle *) stream_.apiHandle;
+  int frameBytes = formatBytes( stream_.deviceFormat[0] ) * stream_.nDeviceChannels[0];
+  if ( change ) stream_.latency[0] = stream_.adaptive.current * stream_.bufferSize;
+
+  if ( stream_.mode == DUPLEX ) {
+    if ( change < 0 ) return false;
+    for ( int i=0; i<change; i++ )
+      if ( write( handle->id[0], &handle->silence[0], handle->silence.size() ) == -1 ) break;
+    return true;
+  }
+
+  int delay;
+  if ( ioctl( handle->id[0], SNDCTL_DSP_GETODELAY, &delay ) == -1 ) return true;
+  int excess = delay - ( stream_.adaptive.current - 1 ) * stream_.bufferSize * frameBytes;
+  if ( excess > 0 )
+    usleep( (useconds_t) ( excess * 1000000.0 / ( frameBytes * stream_.sampleRate ) ) );
+  return true;
+}
+
 void RtApiOss :: callbackEvent()
 {
   OssHandle *handle = (OssHandle *) stream_.apiHandle;
   if ( stream_.state == STREAM_STOPPED ) {
+    // A manually pumped stream has no thread to park.
+    if ( stream_.callbackInfo.manualPump ) return;
+
     MUTEX_LOCK( &stream_.mutex );
+    handle->parked = true;
     pthread_cond_wait( &handle->runnable, &stream_.mutex );
+    handle->parked = false;
     if ( stream_.state != STREAM_RUNNING ) {
       MUTEX_UNLOCK( &stream_.mutex );
       return;
@@ -9334,6 +12865,7 @@ void RtApiOss :: callbackEvent()
     status |= RTAUDIO_INPUT_OVERFLOW;
     handle->xrun[1] = false;
   }
+  int change = updateStreamStats( status );
   doStopStream = callback( stream_.userBuffer[0], stream_.userBuffer[1],
                            stream_.bufferSize, streamTime, status, stream_.callbackInfo.userData );
   if ( doStopStream == 2 ) {
@@ -9370,14 +12902,35 @@ void RtApiOss :: callbackEvent()
     if ( stream_.doByteSwap[0] )
       byteSwapBuffer( buffer, samples, format );
 
-    if ( stream_.mode == DUPLEX && handle->triggered == false ) {
+    if ( stream_.adaptive.maximum && !adaptBuffering( change ) )
+      result = 0;
+    else if ( stream_.mode == DUPLEX && handle->triggered == false ) {
       int trig = 0;
       ioctl( handle->id[0], SNDCTL_DSP_SETTRIGGER, &trig );
+      // The callback waits for input, so the buffers kept filled are
+      // prefilled with silence.
+      if ( stream_.flags & RTAUDIO_PREFILL_OUTPUT ) {
+        for ( unsigned int i=1; i<getFilledBuffers(); i++ )
+          if ( write( handle->id[0], &handle->silence[0], handle->silence.size() ) == -1 ) break;
+      }
       result = write( handle->id[0], buffer, samples * formatBytes(format) );
       trig = PCM_ENABLE_INPUT|PCM_ENABLE_OUTPUT;
       ioctl( handle->id[0], SNDCTL_DSP_SETTRIGGER, &trig );
       handle->triggered = true;
     }
+    else if ( stream_.flags & RTAUDIO_PREFILL_OUTPUT && handle->triggered == false ) {
+      // The output is only triggered once the callback has filled the
+      // buffers kept filled.
+      int trig = 0;
+      if ( handle->prefilled == 0 ) ioctl( handle->id[0], SNDCTL_DSP_SETTRIGGER, &trig );
+      result = write( handle->id[0], buffer, samples * formatBytes(format) );
+      if ( ++handle->prefilled >= getFilledBuffers() ) {
+        trig = PCM_ENABLE_OUTPUT;
+        ioctl( handle->id[0], SNDCTL_DSP_SETTRIGGER, &trig );
+        handle->triggered = true;
+        handle->prefilled = 0;
+      }
+    }
     else
       // Write samples to device.
       result = write( handle->id[0], buffer, samples * formatBytes(format) );
@@ -9451,6 +13004,7 @@ static void *ossCallbackHandler( void *ptr )
 //******************** End of __LINUX_OSS__ *********************//
 #endif
 
+#if !defined(__RTAUDIO_PLUGIN_ONLY__)
 
 // *************************************************** //
 //
@@ -9508,12 +13062,23 @@ void RtApi :: clearStreamInfo()
   stream_.userFormat = 0;
   stream_.userInterleaved = true;
   stream_.streamTime = 0.0;
+  stream_.startTime = 0.0;
+  stream_.startOffset = 0.0;
   stream_.apiHandle = 0;
   stream_.deviceBuffer = 0;
   stream_.callbackInfo.callback = 0;
   stream_.callbackInfo.userData = 0;
   stream_.callbackInfo.isRunning = false;
+  stream_.callbackInfo.manualPump = false;
   stream_.callbackInfo.errorCallback = 0;
+  stream_.flags = 0;
+  stream_.adaptive.minimum = 0;
+  stream_.adaptive.maximum = 0;
+  stream_.adaptive.current = 0;
+  stream_.adaptive.xruns = 0;
+  stream_.adaptive.windowStart = 0.0;
+  stream_.adaptive.lastChange = 0.0;
+  stream_.stats = RtAudio::StreamStats();
   for ( int i=0; i<2; i++ ) {
     stream_.device[i] = 11111;
     stream_.doConvertBuffer[i] = false;
@@ -9535,6 +13100,45 @@ void RtApi :: clearStreamInfo()
   }
 }
 
+bool RtApi :: resizeStreamBuffers( void )
+{
+  unsigned long deviceBytes = 0;
+  for ( int mode=0; mode<2; mode++ ) {
+    if ( stream_.userBuffer[mode] == 0 ) continue;
+
+    unsigned long bufferBytes = stream_.nUserChannels[mode] * stream_.bufferSize * formatBytes( stream_.userFormat );
+    char *buffer = (char *) realloc( stream_.userBuffer[mode], bufferBytes );
+    if ( buffer == NULL ) {
+      errorText_ = "RtApi::resizeStreamBuffers: error allocating user buffer memory.";
+      return FAILURE;
+    }
+    memset( buffer, 0, bufferBytes );
+    stream_.userBuffer[mode] = buffer;
+
+    if ( stream_.doConvertBuffer[mode] ) {
+      bufferBytes = stream_.nDeviceChannels[mode] * stream_.bufferSize * formatBytes( stream_.deviceFormat[mode] );
+      if ( bufferBytes > deviceBytes ) deviceBytes = bufferBytes;
+
+      // The offsets of non-interleaved buffers depend on the buffer size.
+      stream_.convertInfo[mode].inOffset.clear();
+      stream_.convertInfo[mode].outOffset.clear();
+      setConvertInfo( (StreamMode) mode, stream_.channelOffset[mode] );
+    }
+  }
+
+  if ( deviceBytes ) {
+    char *buffer = (char *) realloc( stream_.deviceBuffer, deviceBytes );
+    if ( buffer == NULL ) {
+      errorText_ = "RtApi::resizeStreamBuffers: error allocating device buffer memory.";
+      return FAILURE;
+    }
+    memset( buffer, 0, deviceBytes );
+    stream_.deviceBuffer = buffer;
+  }
+
+  return SUCCESS;
+}
+
 unsigned int RtApi :: formatBytes( RtAudioFormat format )
 {
   if ( format == RTAUDIO_SINT16 )
@@ -10148,6 +13752,8 @@ void RtApi :: byteSwapBuffer( char *buffer, unsigned int samples, RtAudioFormat
   }
 }
 
+#endif // !__RTAUDIO_PLUGIN_ONLY__
+
   // Indentation settings for Vim and Emacs
   //
   // Local Variables:
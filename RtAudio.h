@@ -61,6 +61,10 @@
 #include <vector>
 #include <stdexcept>
 #include <iostream>
+#include <cstring>
+#if defined(_MSC_VER)
+  #include <intrin.h>
+#endif
 
 /*! \typedef typedef unsigned long RtAudioFormat;
     \brief RtAudio data format type.
@@ -97,6 +101,13 @@ static const RtAudioFormat RTAUDIO_FLOAT64 = 0x20; // Normalized between plus/mi
     - \e RTAUDIO_HOG_DEVICE:       Attempt grab device for exclusive use.
     - \e RTAUDIO_ALSA_USE_DEFAULT: Use the "default" PCM device (ALSA only).
     - \e RTAUDIO_JACK_DONT_CONNECT: Do not automatically connect ports (JACK only).
+    - \e RTAUDIO_MANUAL_PUMP: Do not create a callback thread; the client drives the stream (ALSA, PulseAudio and OSS only).
+    - \e RTAUDIO_INDEPENDENT_DUPLEX: Run the input and output devices of a duplex stream on their own clocks.
+    - \e RTAUDIO_FIXED_BLOCK_SIZE: Always invoke the callback with the requested number of frames.
+    - \e RTAUDIO_ADAPTIVE_BUFFERING: Raise the output buffering after repeated xruns (ALSA and OSS only).
+    - \e RTAUDIO_WARM_STOP: Keep the devices ready between runs for a fast restart (ALSA only).
+    - \e RTAUDIO_PREFILL_OUTPUT: Fill the output buffers before the devices are started (ALSA and OSS only).
+    - \e RTAUDIO_CATCH_UP: Count late wakeups and process all ready buffers in one tick (ALSA only).
 
     By default, RtAudio streams pass and receive audio data from the
     client in an interleaved format.  By passing the
@@ -131,6 +142,42 @@ static const RtAudioFormat RTAUDIO_FLOAT64 = 0x20; // Normalized between plus/mi
 
     If the RTAUDIO_JACK_DONT_CONNECT flag is set, RtAudio will not attempt
     to automatically connect the ports of the client to the audio device.
+
+    If the RTAUDIO_MANUAL_PUMP flag is set, RtAudio will not create an
+    internal callback thread.  Instead, the client must repeatedly call
+    RtAudio::tickStream() from its own thread while the stream is
+    running.  This is only possible with the ALSA, PulseAudio and OSS
+    APIs.
+
+    If the RTAUDIO_INDEPENDENT_DUPLEX flag is set for a duplex stream,
+    the input device is not assumed to share the clock or the buffer
+    size of the output device.  It is opened as a secondary device of
+    an aggregate stream (see RtAudio::AggregateDevice), such that the
+    callback still receives aligned input and output blocks.
+
+    If the RTAUDIO_FIXED_BLOCK_SIZE flag is set and the device uses a
+    different buffer size than requested, the callback is still
+    invoked with the requested number of frames, at the cost of a
+    small added latency.
+
+    If the RTAUDIO_ADAPTIVE_BUFFERING flag is set, the output latency
+    of the stream is raised by one buffer after repeated over- or
+    underflows, and lowered again once the stream has run without
+    them for a while (ALSA and OSS only).
+
+    If the RTAUDIO_WARM_STOP flag is set, stopping the stream pauses
+    the devices, or prepares them again if they cannot be paused, and
+    the callback thread waits on a futex, such that the stream can be
+    restarted within about one buffer (ALSA only).
+
+    If the RTAUDIO_PREFILL_OUTPUT flag is set, the output devices are
+    only started once all the output buffers kept filled have been
+    written, such that playback begins with full headroom (ALSA and
+    OSS only).
+
+    If the RTAUDIO_CATCH_UP flag is set, the wakeups that find
+    several buffers ready are counted, and a single tickStream()
+    processes all of them (ALSA only).
 */
 typedef unsigned int RtAudioStreamFlags;
 static const RtAudioStreamFlags RTAUDIO_NONINTERLEAVED = 0x1;    // Use non-interleaved buffers (default = interleaved).
@@ -139,6 +186,13 @@ static const RtAudioStreamFlags RTAUDIO_HOG_DEVICE = 0x4;        // Attempt grab
 static const RtAudioStreamFlags RTAUDIO_SCHEDULE_REALTIME = 0x8; // Try to select realtime scheduling for callback thread.
 static const RtAudioStreamFlags RTAUDIO_ALSA_USE_DEFAULT = 0x10; // Use the "default" PCM device (ALSA only).
 static const RtAudioStreamFlags RTAUDIO_JACK_DONT_CONNECT = 0x20; // Do not automatically connect ports (JACK only).
+static const RtAudioStreamFlags RTAUDIO_MANUAL_PUMP = 0x40;      // Do not create a callback thread, use tickStream() instead.
+static const RtAudioStreamFlags RTAUDIO_INDEPENDENT_DUPLEX = 0x80; // Bridge duplex input and output devices with an elastic buffer.
+static const RtAudioStreamFlags RTAUDIO_FIXED_BLOCK_SIZE = 0x100;  // Invoke the callback with the requested buffer size.
+static const RtAudioStreamFlags RTAUDIO_ADAPTIVE_BUFFERING = 0x200; // Adapt the output buffering to the xrun rate.
+static const RtAudioStreamFlags RTAUDIO_WARM_STOP = 0x400;       // Keep the devices ready for a fast restart.
+static const RtAudioStreamFlags RTAUDIO_PREFILL_OUTPUT = 0x800;  // Start the output devices with full buffers.
+static const RtAudioStreamFlags RTAUDIO_CATCH_UP = 0x1000;       // Process all ready buffers when the callback is late.
 
 /*! \typedef typedef unsigned long RtAudioStreamStatus;
     \brief RtAudio stream status (over- or underflow) flags.
@@ -255,6 +309,249 @@ class RTAUDIO_DLL_PUBLIC RtAudioError : public std::runtime_error
  */
 typedef void (*RtAudioErrorCallback)( RtAudioError::Type type, const std::string &errorText );
 
+//! RtAudio device change callback function prototype.
+/*!
+    \param userData A pointer to optional data provided by the client
+           when setting the callback function.
+ */
+typedef void (*RtAudioDeviceCallback)( void *userData );
+
+// The full memory barrier and the compare-and-swap operation used by
+// the lock-free RtAudioRingBuffer class.
+#if defined(__GNUC__)
+  #define RTAUDIO_MEMORY_BARRIER() __sync_synchronize()
+  #define RTAUDIO_COMPARE_AND_SWAP(P, O, N) __sync_bool_compare_and_swap( (P), (O), (N) )
+#elif defined(_MSC_VER)
+  #define RTAUDIO_MEMORY_BARRIER() do { long barrier_ = 0; _InterlockedExchange( &barrier_, 1 ); } while ( 0 )
+  #define RTAUDIO_COMPARE_AND_SWAP(P, O, N) \
+    ( _InterlockedCompareExchange( (volatile long *) (P), (long) (N), (long) (O) ) == (long) (O) )
+#else
+  // Without compiler support, the barrier is empty and the
+  // compare-and-swap is not atomic, such that RtAudioRingBuffer is
+  // only safe with a single producer on strongly ordered processors.
+  #define RTAUDIO_MEMORY_BARRIER()
+  #define RTAUDIO_COMPARE_AND_SWAP(P, O, N) rtaudioCompareAndSwap( (P), (O), (N) )
+  template <class V> inline bool rtaudioCompareAndSwap( volatile V *p, V o, V n )
+  { if ( *p != o ) return false; *p = n; return true; }
+#endif
+
+// Gives up the processor to another thread, for the producers that
+// wait for an earlier producer in RtAudioRingBuffer.  It is defined
+// in RtAudio.cpp, such that this header needs no system headers.
+RTAUDIO_DLL_PUBLIC void rtaudioYield( void );
+
+//! The assumed size of a cache line, in bytes.
+#define RTAUDIO_CACHE_LINE_SIZE 64
+
+//! The number of checks for an earlier producer before yielding.
+#define RTAUDIO_PRODUCER_SPINS 100
+
+/************************************************************************/
+/*! \class RtAudioRingBuffer
+    \brief A lock-free ring buffer of audio frames.
+
+    RtAudioRingBuffer moves interleaved frames of \c T samples between
+    threads, typically between a stream callback and a worker thread,
+    without any lock or system call.  Its capacity is a power of two,
+    such that the read and write indices wrap with a mask, and the
+    indices of the producer and the consumer are kept on separate
+    cache lines to avoid false sharing.
+
+    In SINGLE_PRODUCER mode, one thread may write while one other
+    thread reads.  In MULTI_PRODUCER mode, several threads may write
+    concurrently: they claim space with a compare-and-swap operation
+    and publish their frames in the order in which they claimed them.
+    A producer that must wait for an earlier one to publish spins
+    briefly, then yields the processor until it is done.  Yielding
+    does not let a thread of lower priority run, so producers at
+    realtime priority should not outnumber the processors.  There must
+    always be a single consumer.
+
+    The reserveWrite() and commitWrite() functions give direct access
+    to the storage, for example to let a decoder or a callback render
+    into the ring buffer without an intermediate copy.  Likewise,
+    reserveRead() and commitRead() give the consumer direct access to
+    the readable frames.  A reservation may be split in two regions
+    where the storage wraps around.
+
+    The allocate() and reset() functions are not thread-safe.
+*/
+/************************************************************************/
+
+template <class T>
+class RtAudioRingBuffer
+{
+ public:
+  //! The number of producer threads that may write concurrently.
+  enum Mode {
+    SINGLE_PRODUCER, /*!< A single thread writes frames. */
+    MULTI_PRODUCER   /*!< Several threads may write frames concurrently. */
+  };
+
+  //! A reserved part of the storage, split in two where it wraps around.
+  struct Region {
+    T *data[2];             /*!< The first sample of each part. */
+    unsigned int frames[2]; /*!< The number of frames in each part. */
+    unsigned int start;     /*!< The index of the first frame (internal use). */
+
+    //! Returns the total number of frames in the region.
+    unsigned int size( void ) const { return frames[0] + frames[1]; }
+  };
+
+  //! The constructor, which allocates at least \c frames frames of \c channels samples.
+  RtAudioRingBuffer( unsigned int frames = 0, unsigned int channels = 1, Mode mode = SINGLE_PRODUCER )
+    : data_(0), channels_(0), mask_(0), mode_(mode), writeIndex_(0), reserveIndex_(0), readIndex_(0)
+    { if ( frames ) allocate( frames, channels ); }
+
+  //! The destructor.
+  ~RtAudioRingBuffer() { delete [] data_; }
+
+  //! Allocates at least \c frames frames of \c channels samples and empties the buffer.
+  void allocate( unsigned int frames, unsigned int channels )
+  {
+    unsigned int size = 1;
+    while ( size < frames ) size <<= 1;
+    delete [] data_;
+    data_ = new T[size * channels];
+    memset( data_, 0, size * channels * sizeof( T ) );
+    channels_ = channels;
+    mask_ = size - 1;
+    reset();
+  }
+
+  //! Discards all frames.
+  void reset( void ) { writeIndex_ = 0; reserveIndex_ = 0; readIndex_ = 0; }
+
+  //! Sets whether several threads may write concurrently.
+  void setMode( Mode mode ) { mode_ = mode; }
+
+  //! Returns the capacity, in frames.
+  unsigned int getCapacity( void ) const { return data_ ? mask_ + 1 : 0; }
+
+  //! Returns the number of samples per frame.
+  unsigned int getChannels( void ) const { return channels_; }
+
+  //! Returns the number of frames that can be read.
+  unsigned int readAvailable( void ) const { return writeIndex_ - readIndex_; }
+
+  //! Returns the number of frames that can be written.
+  unsigned int writeAvailable( void ) const { return getCapacity() - ( reserveIndex_ - readIndex_ ); }
+
+  //! Reserves up to \c nFrames frames for writing and returns the number of frames reserved.
+  /*!
+    The frames become readable when commitWrite() is called with the
+    same region, which must be done even if no frames were reserved.
+  */
+  unsigned int reserveWrite( unsigned int nFrames, Region *region )
+  {
+    unsigned int start, space;
+    while ( true ) {
+      start = reserveIndex_;
+      space = getCapacity() - ( start - readIndex_ );
+      if ( nFrames > space ) nFrames = space;
+      if ( mode_ == SINGLE_PRODUCER ) {
+        reserveIndex_ = start + nFrames;
+        break;
+      }
+      if ( nFrames == 0 || RTAUDIO_COMPARE_AND_SWAP( &reserveIndex_, start, start + nFrames ) ) break;
+    }
+    setRegion( start, nFrames, region );
+    return nFrames;
+  }
+
+  //! Makes the frames of a region returned by reserveWrite() readable.
+  void commitWrite( const Region &region )
+  {
+    if ( region.size() == 0 ) return;
+
+    // Other producers publish their earlier reservations first.
+    if ( mode_ == MULTI_PRODUCER ) {
+      for ( unsigned int spins=0; writeIndex_ != region.start; spins++ ) {
+        if ( spins < RTAUDIO_PRODUCER_SPINS ) RTAUDIO_MEMORY_BARRIER();
+        else rtaudioYield();
+      }
+    }
+    RTAUDIO_MEMORY_BARRIER();
+    writeIndex_ = region.start + region.size();
+  }
+
+  //! Copies up to \c nFrames frames into the buffer and returns the number of frames written.
+  unsigned int write( const T *frames, unsigned int nFrames )
+  {
+    Region region;
+    nFrames = reserveWrite( nFrames, &region );
+    memcpy( region.data[0], frames, region.frames[0] * channels_ * sizeof( T ) );
+    memcpy( region.data[1], frames + region.frames[0] * channels_, region.frames[1] * channels_ * sizeof( T ) );
+    commitWrite( region );
+    return nFrames;
+  }
+
+  //! Returns up to \c nFrames readable frames, which stay in the buffer until commitRead() is called.
+  unsigned int reserveRead( unsigned int nFrames, Region *region )
+  {
+    unsigned int available = readAvailable();
+    if ( nFrames > available ) nFrames = available;
+    RTAUDIO_MEMORY_BARRIER();
+    setRegion( readIndex_, nFrames, region );
+    return nFrames;
+  }
+
+  //! Removes \c nFrames frames, which must be readable, from the buffer.
+  void commitRead( unsigned int nFrames )
+  {
+    RTAUDIO_MEMORY_BARRIER();
+    readIndex_ += nFrames;
+  }
+
+  //! Copies up to \c nFrames frames out of the buffer, without removing them, and returns the number of frames copied.
+  unsigned int peek( T *frames, unsigned int nFrames )
+  {
+    Region region;
+    nFrames = reserveRead( nFrames, &region );
+    memcpy( frames, region.data[0], region.frames[0] * channels_ * sizeof( T ) );
+    memcpy( frames + region.frames[0] * channels_, region.data[1], region.frames[1] * channels_ * sizeof( T ) );
+    return nFrames;
+  }
+
+  //! Copies up to \c nFrames frames out of the buffer and returns the number of frames read.
+  unsigned int read( T *frames, unsigned int nFrames )
+  {
+    nFrames = peek( frames, nFrames );
+    commitRead( nFrames );
+    return nFrames;
+  }
+
+ private:
+  // Not copyable.
+  RtAudioRingBuffer( const RtAudioRingBuffer & );
+  RtAudioRingBuffer &operator=( const RtAudioRingBuffer & );
+
+  void setRegion( unsigned int start, unsigned int nFrames, Region *region ) const
+  {
+    unsigned int offset = start & mask_;
+    unsigned int first = mask_ + 1 - offset;
+    if ( first > nFrames ) first = nFrames;
+    region->data[0] = data_ + offset * channels_;
+    region->frames[0] = first;
+    region->data[1] = data_;
+    region->frames[1] = nFrames - first;
+    region->start = start;
+  }
+
+  // The configuration is read by both sides, while each index is
+  // written by one side only.
+  T *data_;
+  unsigned int channels_;
+  unsigned int mask_;
+  Mode mode_;
+  char pad0_[RTAUDIO_CACHE_LINE_SIZE];
+  volatile unsigned int writeIndex_;
+  volatile unsigned int reserveIndex_;
+  char pad1_[RTAUDIO_CACHE_LINE_SIZE - 2 * sizeof( unsigned int )];
+  volatile unsigned int readIndex_;
+  char pad2_[RTAUDIO_CACHE_LINE_SIZE - sizeof( unsigned int )];
+};
+
 // **************************************************************** //
 //
 // RtAudio class declaration.
@@ -269,6 +566,8 @@ typedef void (*RtAudioErrorCallback)( RtAudioError::Type type, const std::string
 // **************************************************************** //
 
 class RtApi;
+class RtAudioEngine;
+struct pollfd;
 
 class RTAUDIO_DLL_PUBLIC RtAudio
 {
@@ -292,19 +591,50 @@ class RTAUDIO_DLL_PUBLIC RtAudio
   struct DeviceInfo {
     bool probed;                  /*!< true if the device capabilities were successfully probed. */
     std::string name;             /*!< Character string device identifier. */
+    std::string identifier;       /*!< Persistent device identifier, or empty if not supported by the API (ALSA, JACK and OSS only). */
     unsigned int outputChannels;  /*!< Maximum output channels supported by device. */
     unsigned int inputChannels;   /*!< Maximum input channels supported by device. */
     unsigned int duplexChannels;  /*!< Maximum simultaneous input/output channels supported by device. */
     bool isDefaultOutput;         /*!< true if this is the default output device. */
     bool isDefaultInput;          /*!< true if this is the default input device. */
-    std::vector<unsigned int> sampleRates; /*!< Supported sample rates (queried from list of standard rates). */
+    std::vector<unsigned int> sampleRates; /*!< Supported sample rates (queried from list of standard rates, plus the limits of a discrete range). */
     unsigned int preferredSampleRate; /*!< Preferred sample rate, eg. for WASAPI the system sample rate. */
     RtAudioFormat nativeFormats;  /*!< Bit mask of supported data formats. */
+    unsigned int minSampleRate;   /*!< Lowest supported sample rate, or zero if unknown (ALSA and OSS only). */
+    unsigned int maxSampleRate;   /*!< Highest supported sample rate, or zero if unknown (ALSA and OSS only). */
 
     // Default constructor.
     DeviceInfo()
       :probed(false), outputChannels(0), inputChannels(0), duplexChannels(0),
-       isDefaultOutput(false), isDefaultInput(false), preferredSampleRate(0), nativeFormats(0) {}
+       isDefaultOutput(false), isDefaultInput(false), preferredSampleRate(0), nativeFormats(0),
+       minSampleRate(0), maxSampleRate(0) {}
+  };
+
+  //! The structure for specifying a secondary device of an aggregate stream.
+  /*!
+    When the aggregateDevices member of a StreamParameters structure
+    is not empty, the stream combines the device given by its
+    deviceId with these secondary devices of the same API, for
+    example to use more channels than a single card offers.  The user
+    buffers hold the nChannels channels of the primary device followed
+    by the channels of each secondary device, in order, and the
+    callback runs on the clock of the primary device.
+
+    Each secondary device runs its own callback thread from
+    openStream() until closeStream().  Its clock drift relative to the
+    primary device is estimated with a delay-locked loop and corrected
+    with an adaptive resampler.  The elastic buffer between the two
+    adds about one primary and one secondary buffer of latency, which
+    is included in the value returned by getStreamLatency().
+  */
+  struct AggregateDevice {
+    unsigned int deviceId;     /*!< Device index (0 to getDeviceCount() - 1). */
+    unsigned int nChannels;    /*!< Number of channels. */
+    unsigned int firstChannel; /*!< First channel index on device (default = 0). */
+
+    // Default constructor.
+    AggregateDevice()
+      : deviceId(0), nChannels(0), firstChannel(0) {}
   };
 
   //! The structure for specifying input or ouput stream parameters.
@@ -312,6 +642,8 @@ class RTAUDIO_DLL_PUBLIC RtAudio
     unsigned int deviceId;     /*!< Device index (0 to getDeviceCount() - 1). */
     unsigned int nChannels;    /*!< Number of channels. */
     unsigned int firstChannel; /*!< First channel index on device (default = 0). */
+    std::vector<RtAudio::AggregateDevice> aggregateDevices; /*!< Secondary devices of an aggregate stream (default = none). */
+    std::string deviceIdentifier; /*!< Persistent device identifier, used instead of deviceId if not empty (default = empty). */
 
     // Default constructor.
     StreamParameters()
@@ -328,6 +660,13 @@ class RTAUDIO_DLL_PUBLIC RtAudio
     - \e RTAUDIO_HOG_DEVICE:        Attempt grab device for exclusive use.
     - \e RTAUDIO_SCHEDULE_REALTIME: Attempt to select realtime scheduling for callback thread.
     - \e RTAUDIO_ALSA_USE_DEFAULT:  Use the "default" PCM device (ALSA only).
+    - \e RTAUDIO_MANUAL_PUMP:       Do not create a callback thread (ALSA, PulseAudio and OSS only).
+    - \e RTAUDIO_INDEPENDENT_DUPLEX: Run the input and output devices of a duplex stream on their own clocks.
+    - \e RTAUDIO_FIXED_BLOCK_SIZE: Always invoke the callback with the requested number of frames.
+    - \e RTAUDIO_ADAPTIVE_BUFFERING: Raise the output buffering after repeated xruns (ALSA and OSS only).
+    - \e RTAUDIO_WARM_STOP: Keep the devices ready between runs for a fast restart (ALSA only).
+    - \e RTAUDIO_PREFILL_OUTPUT: Fill the output buffers before the devices are started (ALSA and OSS only).
+    - \e RTAUDIO_CATCH_UP: Count late wakeups and process all ready buffers in one tick (ALSA only).
 
     By default, RtAudio streams pass and receive audio data from the
     client in an interleaved format.  By passing the
@@ -362,6 +701,59 @@ class RTAUDIO_DLL_PUBLIC RtAudio
     open the "default" PCM device when using the ALSA API. Note that this
     will override any specified input or output device id.
 
+    If the RTAUDIO_MANUAL_PUMP flag is set, no callback thread is
+    created and the RTAUDIO_SCHEDULE_REALTIME flag is ignored.  The
+    client drives the stream by calling RtAudio::tickStream().
+
+    If the RTAUDIO_INDEPENDENT_DUPLEX flag is set, the input device of
+    a duplex stream may be a different card, or negotiate a different
+    buffer size, than the output device.  The input is passed through
+    an elastic buffer with drift compensation, whose latency is
+    returned by RtAudio::getStreamAddedLatency().
+
+    If the RTAUDIO_FIXED_BLOCK_SIZE flag is set with a non-zero
+    \c bufferFrames value, the callback is always invoked with that
+    number of frames, which openStream() then leaves unchanged, even
+    if the device negotiates a different buffer size.  An adapter
+    between the two block sizes adds less than one user block of
+    latency, which is returned by RtAudio::getStreamAddedLatency().
+
+    If the RTAUDIO_ADAPTIVE_BUFFERING flag is set, the ALSA and OSS
+    APIs allocate up to twice the requested number of buffers, but
+    only keep the requested number filled with output.  After two
+    over- or underflows within ten seconds, one more buffer is kept
+    filled, up to the allocated number, and after thirty seconds
+    without any, one less, down to the requested number.  The current
+    latency is returned by RtAudio::getStreamLatency() and the
+    changes are counted in RtAudio::StreamStats.
+
+    If the RTAUDIO_WARM_STOP flag is set, the ALSA API neither drains
+    the output nor releases the devices when the stream is stopped.
+    The devices are paused if the hardware supports it, in which case
+    the queued output is played when the stream is started again, and
+    otherwise they are prepared right away.  abortStream() always
+    discards the queued output.  The callback thread waits on a futex
+    rather than on a condition variable, such that the first callback
+    follows startStream() within about one buffer.
+
+    If the RTAUDIO_PREFILL_OUTPUT flag is set, the ALSA and OSS APIs
+    invoke the callback of an output stream back-to-back, once for
+    each buffer kept filled, before the device is started by a start
+    threshold (ALSA) or trigger (OSS).  The same applies when an ALSA
+    stream recovers from an underflow.  The callback of a duplex
+    stream waits for input, so its output is prefilled with silence
+    instead.
+
+    The ALSA callback thread always invokes the callback
+    back-to-back while buffers are ready, since reading or writing
+    does not block then.  If the RTAUDIO_CATCH_UP flag is set, it
+    also queries how many buffers are ready at each wakeup (one
+    snd_pcm_avail() call), counts a catch-up in RtAudio::StreamStats
+    when there are several, and skips the stream latency query
+    (snd_pcm_delay()) until they are processed.  With the
+    RTAUDIO_MANUAL_PUMP flag, a single call to RtAudio::tickStream()
+    then processes them all, rather than one.
+
     The \c numberOfBuffers parameter can be used to control stream
     latency in the Windows DirectSound, Linux OSS, and Linux Alsa APIs
     only.  A value of two is usually the smallest allowed.  Larger
@@ -374,16 +766,49 @@ class RTAUDIO_DLL_PUBLIC RtAudio
     when using the Jack API.  By default, the client name is set to
     RtApiJack.  However, if you wish to create multiple instances of
     RtAudio with Jack, each instance must have a unique client name.
+
+    The \c targetLatency parameter, in microseconds, replaces the
+    \c bufferFrames argument of openStream() and the \c numberOfBuffers
+    parameter with a latency target in the Linux ALSA, OSS and
+    PulseAudio APIs.  Among the buffer configurations supported by the
+    device that do not exceed the target, the one with the fewest
+    wakeups per second is chosen, with as many buffers as fit in the
+    target.  If no configuration meets the target, the one with the
+    lowest latency is used.  The resulting latencies are returned by
+    RtAudio::getStreamInputLatency() and
+    RtAudio::getStreamOutputLatency().
   */
   struct StreamOptions {
     RtAudioStreamFlags flags;      /*!< A bit-mask of stream flags (RTAUDIO_NONINTERLEAVED, RTAUDIO_MINIMIZE_LATENCY, RTAUDIO_HOG_DEVICE, RTAUDIO_ALSA_USE_DEFAULT). */
     unsigned int numberOfBuffers;  /*!< Number of stream buffers. */
     std::string streamName;        /*!< A stream name (currently used only in Jack). */
     int priority;                  /*!< Scheduling priority of callback thread (only used with flag RTAUDIO_SCHEDULE_REALTIME). */
+    unsigned int targetLatency;    /*!< Target latency in microseconds (default = 0, use bufferFrames and numberOfBuffers). */
 
     // Default constructor.
     StreamOptions()
-    : flags(0), numberOfBuffers(0), priority(0) {}
+    : flags(0), numberOfBuffers(0), priority(0), targetLatency(0) {}
+  };
+
+  //! The structure for the statistics of an open stream.
+  /*!
+    The counters are reset when a stream is opened and are updated
+    by the callback thread, such that their values may be one
+    callback late.
+  */
+  struct StreamStats {
+    unsigned long callbacks;        /*!< The number of callbacks invoked. */
+    unsigned long inputOverflows;   /*!< The number of callbacks reporting an input overflow. */
+    unsigned long outputUnderflows; /*!< The number of callbacks reporting an output underflow. */
+    unsigned long bufferIncreases;  /*!< The number of times adaptive buffering raised the latency. */
+    unsigned long bufferDecreases;  /*!< The number of times adaptive buffering lowered the latency. */
+    unsigned int nBuffers;          /*!< The number of output buffers currently kept filled. */
+    unsigned long catchUps;         /*!< The number of wakeups that processed several buffers back-to-back. */
+
+    // Default constructor.
+    StreamStats()
+    : callbacks(0), inputOverflows(0), outputUnderflows(0),
+      bufferIncreases(0), bufferDecreases(0), nBuffers(0), catchUps(0) {}
   };
 
   //! A static function to determine the current RtAudio version.
@@ -397,14 +822,29 @@ class RTAUDIO_DLL_PUBLIC RtAudio
   */
   static void getCompiledApi( std::vector<RtAudio::Api> &apis );
 
+  //! A static function to find a compiled API by its short name.
+  /*!
+    The names are "jack", "alsa", "pulse", "oss", "asio", "wasapi",
+    "ds", "core" and "dummy".  The return value is UNSPECIFIED if
+    the name is unknown or the API is not compiled.
+  */
+  static RtAudio::Api getCompiledApiByName( const std::string &name );
+
   //! The class constructor.
   /*!
     The constructor performs minor initialization tasks.  An exception
     can be thrown if no API support is compiled.
 
     If no API argument is specified and multiple API support has been
-    compiled, the default order of use is JACK, ALSA, OSS (Linux
-    systems) and ASIO, DS (Windows systems).
+    compiled, the default order of use is JACK, ALSA, PulseAudio, OSS
+    (Linux systems) and ASIO, WASAPI, DS (Windows systems).  The
+    RTAUDIO_API environment variable can name the API to use instead
+    (see getCompiledApiByName()).  The Linux APIs are selected by the
+    presence of their server socket or device nodes, without
+    enumerating their devices: JACK if a server socket of the user
+    exists, ALSA if a sound card exists, PulseAudio if a server socket
+    exists and OSS if /dev/mixer exists.  Other APIs are selected
+    when they report at least one device.
   */
   RtAudio( RtAudio::Api api=UNSPECIFIED );
 
@@ -415,6 +855,21 @@ class RTAUDIO_DLL_PUBLIC RtAudio
   */
   ~RtAudio();
 
+  //! Create an additional RtAudio instance that shares this instance's API.
+  /*!
+    Each RtAudio instance can open a single stream.  The instance
+    returned by this function uses the same API as this one and shares
+    its saved device information and API context (for example, the
+    JACK client used for device queries), so that a further stream can
+    be opened without repeating API selection and device probing.
+    Devices held open by a stream of any sharing instance are reported
+    with the information saved before they were opened.  The returned
+    instance must be deleted by the caller and can outlive this one.
+    Streams of sharing instances should not be opened concurrently
+    from different threads.
+  */
+  RtAudio *createStreamHandle( void );
+
   //! Returns the audio API specifier for the current instance of RtAudio.
   RtAudio::Api getCurrentApi( void );
 
@@ -423,6 +878,8 @@ class RTAUDIO_DLL_PUBLIC RtAudio
     This function performs a system query of available devices each time it
     is called, thus supporting devices connected \e after instantiation. If
     a system error occurs during processing, a warning will be issued. 
+    The ALSA API caches its enumeration, and the probed device
+    information, until a card is added or removed in /dev/snd.
   */
   unsigned int getDeviceCount( void );
 
@@ -439,6 +896,71 @@ class RTAUDIO_DLL_PUBLIC RtAudio
   */
   RtAudio::DeviceInfo getDeviceInfo( unsigned int device );
 
+  //! Return an RtAudio::DeviceInfo structure for each available device.
+  /*!
+    The structures are indexed by device number, as for
+    getDeviceInfo(), but the devices are enumerated only once, and
+    the JACK and OSS APIs query the capabilities of all devices
+    together.  If a device is busy or otherwise unavailable, the
+    structure member "probed" will have a value of "false".  The ALSA
+    API probes the devices on a few threads, and gives up on a device
+    that takes more than two seconds with a warning.
+
+    If \c probeCapabilities is false, only the names, channels and
+    default flags of the devices are probed, and their supported
+    sample rates and native formats are left empty, which saves
+    opening each ALSA device once more and testing it.  A later call
+    to getDeviceInfo() completes the structure of a device.
+  */
+  std::vector<RtAudio::DeviceInfo> getDevices( bool probeCapabilities = true );
+
+  //! Find the index of the device with the given persistent identifier.
+  /*!
+    Device indices change when devices are added or removed, while
+    the \c identifier member of an RtAudio::DeviceInfo structure
+    stays the same for a device.  For ALSA, it is the card identifier
+    with the device number (for example, "hw:CARD=PCH,DEV=0"), for
+    JACK the client name, and for OSS the device handle.  The return
+    value is false if no device has the identifier.  A stream can
+    also be opened by identifier with the \c deviceIdentifier member
+    of the RtAudio::StreamParameters structure.
+  */
+  bool findDevice( const std::string &identifier, unsigned int *device );
+
+  //! Set a function to be called when the available devices change.
+  /*!
+    The function is called after devices are added or removed, which
+    saves polling getDeviceCount().  It is called on a thread of
+    RtAudio or of the audio API which is not a realtime thread, but
+    may block the notifications of the API, so it should signal
+    another thread to query the devices rather than query them
+    itself.  A single change may be reported more than once.  A NULL
+    \c callback stops the notifications.
+
+    The ALSA API reports the cards added or removed, and the JACK API
+    the clients and ports registered or unregistered, as well as the
+    shutdown of the server.  With JACK, the function is called on the
+    JACK notification thread, where calling JACK functions, and thus
+    the RtAudio query functions, is not allowed.  With another API, a
+    warning is issued and the return value is false.
+  */
+  bool setDeviceCallback( RtAudioDeviceCallback callback, void *userData = NULL );
+
+  //! Set a file that keeps the probed device capabilities between runs.
+  /*!
+    The capabilities of a device found in the file are used instead
+    of probing the device again, which saves most of the time spent
+    in getDeviceInfo() and getDevices() when a process starts.  The
+    file keeps a fingerprint of each device, made of its card
+    identifier, driver, card name and components and of the kernel
+    release, and a device is probed again when its fingerprint
+    changes.  The file is created or updated after devices are
+    probed.  An empty \c path (the default) disables the cache.  Only the ALSA API uses the file,
+    and not for the "default" device, which depends on the
+    configuration.
+  */
+  void setDeviceCacheFile( const std::string &path );
+
   //! A function that returns the index of the default output device.
   /*!
     If the underlying audio API does not provide a "default
@@ -485,6 +1007,8 @@ class RTAUDIO_DLL_PUBLIC RtAudio
            allowable value is determined.
     \param callback A client-defined function that will be invoked
            when input data is available and/or output data is needed.
+           If NULL, the stream is opened for blocking i/o with
+           readStream() and writeStream().
     \param userData An optional pointer to data that can be accessed
            from within the callback function.
     \param options An optional pointer to a structure containing various
@@ -539,6 +1063,105 @@ class RTAUDIO_DLL_PUBLIC RtAudio
   */
   void abortStream( void );
 
+  //! Process one buffer of a stream opened with the RTAUDIO_MANUAL_PUMP flag.
+  /*!
+    This function performs the same device i/o, buffer conversion and
+    client callback invocation that the internal callback thread
+    would otherwise perform.  It blocks until the device is ready for
+    one buffer of \c bufferFrames sample frames, thus it should be
+    called repeatedly from a client (realtime) thread while the stream
+    is running.  Calling it while the stream is stopped has no effect.
+    An RtAudioError (type = INVALID_USE) is thrown if a stream is not
+    open, if the stream was not opened with the RTAUDIO_MANUAL_PUMP
+    flag or if the current API does not support manual pumping.
+  */
+  void tickStream( void );
+
+  //! Change the buffer size and sample rate of an open stream in place.
+  /*!
+    This is a faster alternative to closing the stream and opening it
+    again with the same devices, channels, format, callback and
+    options: the devices stay open and the callback thread is kept.
+    A running stream is aborted first and then restarted.  On return,
+    \c bufferFrames holds the buffer size actually used, as with
+    openStream().  The stream must not be pumped by tickStream() in
+    the meantime.  Reconfiguration is only supported by the Linux
+    ALSA and OSS APIs, and not by aggregate streams or streams opened
+    with the RTAUDIO_INDEPENDENT_DUPLEX flag, in which case an
+    RtAudioError (type = INVALID_USE) is thrown and the stream is
+    left as it was.  If the devices
+    cannot be reconfigured, the stream is closed and an RtAudioError
+    (type = SYSTEM_ERROR) is thrown.
+  */
+  void reconfigureStream( unsigned int *bufferFrames, unsigned int sampleRate );
+
+  //! Read interleaved input frames from a stream opened without a callback function.
+  /*!
+    A stream opened with a NULL callback function exchanges audio
+    through internal lock-free ring buffers, which the stream's
+    callback thread fills and drains without taking any lock.  This
+    function copies up to \c nFrames sample frames, in the stream's
+    format, from the input ring buffer to \c buffer and returns the
+    number of frames copied.  In blocking mode, it waits until all
+    frames are available or the stream is no longer running.  The
+    RTAUDIO_NONINTERLEAVED flag cannot be used with blocking i/o.  An
+    RtAudioError (type = INVALID_USE) is thrown if a stream is not
+    open or was not opened for blocking input.
+  */
+  unsigned int readStream( void *buffer, unsigned int nFrames, bool blocking = true );
+
+  //! Write interleaved output frames to a stream opened without a callback function.
+  /*!
+    This function copies up to \c nFrames sample frames, in the
+    stream's format, from \c buffer to the output ring buffer and
+    returns the number of frames copied.  In blocking mode, it waits
+    until all frames are written or the stream is no longer running.
+    The output is silent while the ring buffer is empty.  An
+    RtAudioError (type = INVALID_USE) is thrown if a stream is not
+    open or was not opened for blocking output.
+  */
+  unsigned int writeStream( const void *buffer, unsigned int nFrames, bool blocking = true );
+
+  //! Returns the number of frames that readStream() can copy without waiting.
+  /*!
+    An RtAudioError (type = INVALID_USE) is thrown if a stream is not
+    open or was not opened for blocking input.
+  */
+  unsigned int getStreamReadAvailable( void );
+
+  //! Returns the number of frames that writeStream() can copy without waiting.
+  /*!
+    An RtAudioError (type = INVALID_USE) is thrown if a stream is not
+    open or was not opened for blocking output.
+  */
+  unsigned int getStreamWriteAvailable( void );
+
+  //! Start several streams together, for example on different devices sharing a clock.
+  /*!
+    The streams can belong to different RtAudio instances.  ALSA
+    streams are started with their devices linked via snd_pcm_link(),
+    such that the devices start with sample accuracy, after their
+    callbacks have prefilled the output buffers.  Devices that cannot
+    be linked are started as close as possible to a common deadline
+    on the monotonic clock.  The measured start time of each stream,
+    relative to that deadline, is returned by getStreamStartOffset().
+    Linked streams should be stopped with stopStreamGroup(), since
+    stopping one of them stops the linked devices as well.  An
+    RtAudioError (type = INVALID_USE) is thrown if a stream is not
+    open or is already running.  An RtAudioError (type = SYSTEM_ERROR)
+    is thrown if an error occurs during processing.
+  */
+  static void startStreamGroup( const std::vector<RtAudio *> &streams );
+
+  //! Stop the streams started with startStreamGroup() and release the device links.
+  /*!
+    Each stream is stopped as with stopStream().  An RtAudioError
+    (type = INVALID_USE) is thrown if a stream is not open.  An
+    RtAudioError (type = SYSTEM_ERROR) is thrown if an error occurs
+    during processing.
+  */
+  static void stopStreamGroup( const std::vector<RtAudio *> &streams );
+
   //! Returns true if a stream is open and false if not.
   bool isStreamOpen( void ) const;
 
@@ -568,6 +1191,46 @@ class RTAUDIO_DLL_PUBLIC RtAudio
   */
   long getStreamLatency( void );
 
+  //! Returns the latency, in sample frames, added by the internal buffering of a stream.
+  /*!
+    Aggregate streams and streams opened with the
+    RTAUDIO_INDEPENDENT_DUPLEX flag pass the audio of some devices
+    through elastic buffers, and streams opened with the
+    RTAUDIO_FIXED_BLOCK_SIZE flag may adapt the device buffer size to
+    the callback block size.  This buffering is included in the value
+    returned by getStreamLatency().  The return value is zero for
+    other streams.  If a stream is not open, an RtAudioError (type =
+    INVALID_USE) will be thrown.
+  */
+  long getStreamAddedLatency( void );
+
+  //! Returns the input latency of a stream, in sample frames.
+  /*!
+    The value includes the internal buffering added to the input
+    direction.  It is zero for output-only streams.  If a stream is
+    not open, an RtAudioError (type = INVALID_USE) will be thrown.
+  */
+  long getStreamInputLatency( void );
+
+  //! Returns the output latency of a stream, in sample frames.
+  /*!
+    The value includes the internal buffering added to the output
+    direction, and the adaptation between the device and callback
+    block sizes of duplex streams.  It is zero for input-only streams.
+    If a stream is not open, an RtAudioError (type = INVALID_USE)
+    will be thrown.
+  */
+  long getStreamOutputLatency( void );
+
+  //! Returns the statistics of a stream.
+  /*!
+    The over- and underflows reported to the callback, and the
+    changes made by the RTAUDIO_ADAPTIVE_BUFFERING flag, are counted
+    from the time the stream was opened.  If a stream is not open, an
+    RtAudioError (type = INVALID_USE) will be thrown.
+  */
+  StreamStats getStreamStats( void );
+
  //! Returns actual sample rate in use by the stream.
  /*!
    On some systems, the sample rate used may be slightly different
@@ -576,15 +1239,110 @@ class RTAUDIO_DLL_PUBLIC RtAudio
  */
   unsigned int getStreamSampleRate( void );
 
+  //! Returns the measured start time of the stream, in seconds, relative to the deadline of its group.
+  /*!
+    The value is set by startStreamGroup() and can be used to
+    compensate the remaining misalignment between streams.  It is zero
+    for streams that were never started as part of a group and where
+    no monotonic clock is available.  If a stream is not open, an
+    RtAudioError (type = INVALID_USE) will be thrown.
+  */
+  double getStreamStartOffset( void );
+
   //! Specify whether warning messages should be printed to stderr.
   void showWarnings( bool value = true );
 
  protected:
 
+  friend class RtAudioEngine;
+
   void openRtApi( RtAudio::Api api );
   RtApi *rtapi_;
 };
 
+/************************************************************************/
+/*! \class RtAudioEngine
+    \brief Services several RtAudio streams from a single poll loop.
+
+    Each RtAudio stream normally owns an internal callback thread.  When
+    many devices are in use, these threads all wake at the same period
+    boundaries and contend for the available cores.  An RtAudioEngine
+    instead services any number of streams opened with the
+    RTAUDIO_MANUAL_PUMP flag from one thread (or a small number of
+    threads).  Each engine thread waits on the file descriptors of all
+    of its streams and, when a device is ready, calls
+    RtAudio::tickStream() for every ready stream in the order in which
+    the streams were added.  With more than one thread, streams are
+    distributed round-robin over the threads.
+
+    Streams must still be started and stopped with the usual RtAudio
+    functions.  Only stream types that can provide poll descriptors
+    (currently ALSA and OSS) can be added to an engine.
+*/
+/************************************************************************/
+
+class RTAUDIO_DLL_PUBLIC RtAudioEngine
+{
+ public:
+
+  //! The constructor.
+  RtAudioEngine();
+
+  //! The destructor stops the engine threads if they are running.
+  ~RtAudioEngine();
+
+  //! Add an open stream to the engine.
+  /*!
+    The stream must have been opened with the RTAUDIO_MANUAL_PUMP flag
+    and its API must support polling.  Otherwise, or if the engine is
+    running, an RtAudioError (type = INVALID_USE) is thrown.  The
+    RtAudio instance is not owned by the engine.
+  */
+  void addStream( RtAudio *audio );
+
+  //! Remove a stream from the engine.
+  /*!
+    An RtAudioError (type = INVALID_USE) is thrown if the engine is running.
+  */
+  void removeStream( RtAudio *audio );
+
+  //! Returns the number of streams serviced by the engine.
+  unsigned int getStreamCount( void ) const { return (unsigned int) streams_.size(); }
+
+  //! Start the engine threads.
+  /*!
+    \param nThreads The number of engine threads (default = 1).  Stream
+           \e i is serviced by thread \e i modulo \c nThreads.
+    \param realtime If true, RtAudio will attempt to select realtime
+           scheduling (round-robin) for the engine threads.
+    \param priority The realtime priority of the engine threads.
+
+    An RtAudioError (type = THREAD_ERROR) is thrown if a thread cannot
+    be created.  An RtAudioError (type = INVALID_USE) is thrown if the
+    engine is already running or if engine threads are not supported
+    on this platform.
+  */
+  void start( unsigned int nThreads = 1, bool realtime = false, int priority = 0 );
+
+  //! Stop and join the engine threads.  The streams are not stopped.
+  void stop( void );
+
+  //! Returns true if the engine threads are running.
+  bool isRunning( void ) const { return isRunning_; }
+
+  // This function is intended for internal use only.  It must be
+  // public because it is called by the internal thread handler,
+  // which is not a member of RtAudioEngine.
+  void processThread( unsigned int thread );
+
+ protected:
+
+  std::vector<RtAudio *> streams_;
+  unsigned int nThreads_;
+  bool isRunning_;
+  void *engineHandle_; // void pointer for OS-specific thread information
+};
+
 // Operating system dependent thread functionality.
 #if defined(__WINDOWS_DS__) || defined(__WINDOWS_ASIO__) || defined(__WINDOWS_WASAPI__)
 
@@ -624,11 +1382,12 @@ struct CallbackInfo {
   void *apiInfo;   // void pointer for API specific callback information
   bool isRunning;
   bool doRealtime;
+  bool manualPump; // No internal thread, the client calls tickStream().
   int priority;
 
   // Default constructor.
   CallbackInfo()
-  :object(0), callback(0), userData(0), errorCallback(0), apiInfo(0), isRunning(false), doRealtime(false), priority(0) {}
+  :object(0), callback(0), userData(0), errorCallback(0), apiInfo(0), isRunning(false), doRealtime(false), manualPump(false), priority(0) {}
 };
 
 // **************************************************************** //
@@ -690,6 +1449,9 @@ public:
   virtual RtAudio::Api getCurrentApi( void ) = 0;
   virtual unsigned int getDeviceCount( void ) = 0;
   virtual RtAudio::DeviceInfo getDeviceInfo( unsigned int device ) = 0;
+  virtual std::vector<RtAudio::DeviceInfo> getDevices( bool probeCapabilities );
+  virtual bool findDevice( const std::string &identifier, unsigned int *device );
+  virtual bool setDeviceCallback( RtAudioDeviceCallback callback, void *userData );
   virtual unsigned int getDefaultInputDevice( void );
   virtual unsigned int getDefaultOutputDevice( void );
   void openStream( RtAudio::StreamParameters *outputParameters,
@@ -702,17 +1464,56 @@ public:
   virtual void startStream( void ) = 0;
   virtual void stopStream( void ) = 0;
   virtual void abortStream( void ) = 0;
+  virtual void tickStream( void );
+  void reconfigureStream( unsigned int *bufferFrames, unsigned int sampleRate );
   long getStreamLatency( void );
+  long getStreamAddedLatency( void );
+  long getStreamInputLatency( void );
+  long getStreamOutputLatency( void );
+  RtAudio::StreamStats getStreamStats( void );
   unsigned int getStreamSampleRate( void );
+  double getStreamStartOffset( void );
+  static void startStreamGroup( const std::vector<RtApi *> &apis );
+  static void stopStreamGroup( const std::vector<RtApi *> &apis );
   virtual double getStreamTime( void );
   virtual void setStreamTime( double time );
   bool isStreamOpen( void ) const { return stream_.state != STREAM_CLOSED; }
   bool isStreamRunning( void ) const { return stream_.state == STREAM_RUNNING; }
+  bool isStreamManual( void ) const { return stream_.callbackInfo.manualPump; }
+  virtual unsigned int getStreamPollDescriptors( struct pollfd *pfds, unsigned int space );
+  virtual bool isStreamReady( void );
+  void shareContext( RtApi *api );
+  void closeAggregateStream( void );
+  void closeBlockingStream( void );
+  void closeBlockAdapter( void );
+  unsigned int readStream( void *buffer, unsigned int nFrames, bool blocking );
+  unsigned int writeStream( const void *buffer, unsigned int nFrames, bool blocking );
+  unsigned int getStreamReadAvailable( void );
+  unsigned int getStreamWriteAvailable( void );
   void showWarnings( bool value ) { showWarnings_ = value; }
+  void setDeviceCacheFile( const std::string &path ) { deviceCacheFile_ = path; }
+
+  // This function is intended for internal use only.  It must be
+  // public because it is called by the aggregate callback handler,
+  // which is not a member of RtApi.
+  int aggregateCallbackEvent( void *outputBuffer, void *inputBuffer,
+                              double streamTime, RtAudioStreamStatus status );
+
+  // This function is intended for internal use only.  It moves audio
+  // between the callback buffers and the blocking i/o ring buffers.
+  int blockingCallbackEvent( void *outputBuffer, void *inputBuffer, unsigned int nFrames );
+
+  // This function is intended for internal use only.  It invokes the
+  // client callback with fixed-size blocks.
+  int blockAdapterEvent( void *outputBuffer, void *inputBuffer, double streamTime,
+                         RtAudioStreamStatus status );
 
 
 protected:
 
+  friend struct AggregateInfo;
+  friend struct AggregateSecondary;
+
   static const unsigned int MAX_SAMPLE_RATES;
   static const unsigned int SAMPLE_RATES[];
 
@@ -741,6 +1542,16 @@ protected:
     std::vector<int> outOffset;
   };
 
+  // A protected structure for the adaptive buffering of a stream, in
+  // device buffers.  The maximum is zero when it is disabled.
+  struct AdaptiveBuffering {
+    unsigned int minimum, maximum;
+    unsigned int current;     // The number of output buffers kept filled.
+    unsigned int xruns;       // The xruns counted since windowStart.
+    double windowStart;
+    double lastChange;        // Monotonic time of the last xrun or change.
+  };
+
   // A protected structure for audio streams.
   struct RtApiStream {
     unsigned int device[2];    // Playback and record, respectively.
@@ -766,6 +1577,11 @@ protected:
     CallbackInfo callbackInfo;
     ConvertInfo convertInfo[2];
     double streamTime;         // Number of elapsed seconds since the stream started.
+    double startTime;          // Monotonic time at which a stream group member started.
+    double startOffset;        // Start time relative to the deadline of the stream group.
+    RtAudioStreamFlags flags;  // The flags of the stream options.
+    AdaptiveBuffering adaptive;
+    RtAudio::StreamStats stats;
 
 #if defined(HAVE_GETTIMEOFDAY)
     struct timeval lastTickTimestamp;
@@ -775,6 +1591,20 @@ protected:
       :apiHandle(0), deviceBuffer(0) { device[0] = 11111; device[1] = 11111; }
   };
 
+  // A protected structure holding the device information and API
+  // context shared by the instances created with
+  // RtAudio::createStreamHandle().
+  struct RtApiContext {
+    StreamMutex mutex;
+    std::vector<RtApi *> apis;                 // The instances sharing this structure.
+    std::vector<RtAudio::DeviceInfo> devices;  // Device information saved before opening a stream.
+    void *apiHandle;                           // API specific shared handle.
+    void (*closeApiHandle)( void *apiHandle ); // Releases apiHandle with the last instance.
+
+    RtApiContext()
+      :apiHandle(0), closeApiHandle(0) {}
+  };
+
   typedef S24 Int24;
   typedef signed short Int16;
   typedef signed int Int32;
@@ -785,7 +1615,14 @@ protected:
   std::string errorText_;
   bool showWarnings_;
   RtApiStream stream_;
+  RtApiContext *context_;
+  void *aggregateHandle_;
+  void *blockingHandle_;
+  void *blockAdapterHandle_;
   bool firstErrorOccurred_;
+  RtAudioDeviceCallback deviceCallback_;
+  void *deviceUserData_;
+  std::string deviceCacheFile_;
 
   /*!
     Protected, api-specific method that attempts to open a device
@@ -802,9 +1639,118 @@ protected:
   //! A protected function used to increment the stream time.
   void tickStreamTime( void );
 
+  /*!
+    Protected common method that counts a callback and the xruns
+    reported to it.  For streams with adaptive buffering, it returns
+    the change in the number of output buffers to keep filled.
+  */
+  int updateStreamStats( RtAudioStreamStatus status );
+
+  //! Protected common method that returns the number of output buffers kept filled.
+  unsigned int getFilledBuffers( void ) const;
+
   //! Protected common method to clear an RtApiStream structure.
   void clearStreamInfo();
 
+  /*!
+    Protected, api-specific method that applies a new sample rate and
+    buffer size to the open devices of a stopped stream, without
+    closing them.  It waits for the callback thread to park, then
+    updates the stream buffer size, sample rate and latencies, and
+    calls resizeStreamBuffers().  If the devices cannot be
+    reconfigured, the stream is closed and FAILURE is returned.  The
+    default implementation returns FAILURE without closing the stream.
+  */
+  virtual bool reconfigureDevices( unsigned int sampleRate, unsigned int *bufferSize );
+
+  //! Protected, api-specific method that returns true if reconfigureDevices() is implemented.
+  virtual bool canReconfigure( void ) { return false; }
+
+  /*!
+    Protected common method that reallocates the user and device
+    buffers of an open stream, and rebuilds its conversion
+    information, after its buffer size has changed.
+  */
+  bool resizeStreamBuffers( void );
+
+  /*!
+    Protected common method that opens and starts the secondary
+    devices of an aggregate stream, once the primary devices are open.
+  */
+  bool openAggregateStream( RtAudio::StreamParameters *oParams,
+                            RtAudio::StreamParameters *iParams,
+                            RtAudioCallback callback, void *userData,
+                            RtAudio::StreamOptions *options );
+
+  /*!
+    Protected common method that allocates the ring buffers of a
+    stream opened for blocking i/o, for the given number of user
+    channels in each direction and callback block size.
+  */
+  bool openBlockingStream( unsigned int channels[2], unsigned int blockFrames );
+
+  /*!
+    Protected common method that sets up the adapter invoking the
+    client callback with \c blockFrames frames, for the given number
+    of user channels in each direction.
+  */
+  bool openBlockAdapter( unsigned int channels[2], unsigned int blockFrames,
+                         RtAudioCallback callback, void *userData );
+
+  /*!
+    Protected common method that sets up the conversion between a
+    device buffer and the combined user buffer of an aggregate stream.
+  */
+  void setAggregateConvertInfo( ConvertInfo &info, bool toUser, RtAudioFormat format,
+                                unsigned int channels, bool interleaved,
+                                unsigned int firstChannel, unsigned int totalChannels );
+
+  //! Protected common method that detaches this instance from its shared context.
+  void releaseContext( void );
+
+  //! Protected common method that returns true if a stream of a sharing instance has the device open.
+  bool isDeviceOpen( unsigned int device );
+
+  //! Protected common method that returns the number of devices saved in the shared context.
+  unsigned int getSavedDeviceCount( void );
+
+  //! Protected common method that returns true if other instances share the context.
+  bool isContextShared( void );
+
+  /*!
+    Protected common method that copies the device information saved
+    in the shared context, returning false if none was saved for the
+    device.
+  */
+  bool getSavedDeviceInfo( unsigned int device, RtAudio::DeviceInfo &info );
+
+  //! Protected common method that saves the device information in the shared context.
+  void setSavedDeviceInfo( const std::vector<RtAudio::DeviceInfo> &devices );
+
+  /*!
+    Protected method used by startStreamGroup() that starts a stream
+    without starting its devices, such that they can be triggered
+    together later.  It returns false if this is not supported, in
+    which case the stream is started with startStream() at the group
+    deadline.
+  */
+  virtual bool armStreamStart( void );
+
+  //! Protected method that links the devices of an armed stream to this one, returning false on failure.
+  virtual bool linkStream( RtApi *api );
+
+  //! Protected method that releases the device links made by linkStream().
+  virtual void unlinkStream( void );
+
+  //! Protected method that returns true once an armed stream has prefilled its output.
+  virtual bool isStreamPrimed( void );
+
+  //! Protected method that starts the devices of an armed stream.
+  virtual void triggerStreamStart( void );
+
+  //! Protected method that finishes the start of an armed stream and sets its start time.
+  virtual void completeStreamStart( void );
+
   /*!
     Protected common method that throws an RtAudioError (type =
     INVALID_USE) if a stream is not open.
@@ -839,19 +1785,34 @@ protected:
 inline RtAudio::Api RtAudio :: getCurrentApi( void ) { return rtapi_->getCurrentApi(); }
 inline unsigned int RtAudio :: getDeviceCount( void ) { return rtapi_->getDeviceCount(); }
 inline RtAudio::DeviceInfo RtAudio :: getDeviceInfo( unsigned int device ) { return rtapi_->getDeviceInfo( device ); }
+inline std::vector<RtAudio::DeviceInfo> RtAudio :: getDevices( bool probeCapabilities ) { return rtapi_->getDevices( probeCapabilities ); }
+inline bool RtAudio :: findDevice( const std::string &identifier, unsigned int *device ) { return rtapi_->findDevice( identifier, device ); }
+inline bool RtAudio :: setDeviceCallback( RtAudioDeviceCallback callback, void *userData ) { return rtapi_->setDeviceCallback( callback, userData ); }
 inline unsigned int RtAudio :: getDefaultInputDevice( void ) { return rtapi_->getDefaultInputDevice(); }
 inline unsigned int RtAudio :: getDefaultOutputDevice( void ) { return rtapi_->getDefaultOutputDevice(); }
-inline void RtAudio :: closeStream( void ) { return rtapi_->closeStream(); }
+inline void RtAudio :: closeStream( void ) { rtapi_->closeStream(); rtapi_->closeAggregateStream(); rtapi_->closeBlockAdapter(); rtapi_->closeBlockingStream(); }
 inline void RtAudio :: startStream( void ) { return rtapi_->startStream(); }
 inline void RtAudio :: stopStream( void )  { return rtapi_->stopStream(); }
 inline void RtAudio :: abortStream( void ) { return rtapi_->abortStream(); }
+inline void RtAudio :: tickStream( void ) { return rtapi_->tickStream(); }
+inline void RtAudio :: reconfigureStream( unsigned int *bufferFrames, unsigned int sampleRate ) { return rtapi_->reconfigureStream( bufferFrames, sampleRate ); }
+inline unsigned int RtAudio :: readStream( void *buffer, unsigned int nFrames, bool blocking ) { return rtapi_->readStream( buffer, nFrames, blocking ); }
+inline unsigned int RtAudio :: writeStream( const void *buffer, unsigned int nFrames, bool blocking ) { return rtapi_->writeStream( buffer, nFrames, blocking ); }
+inline unsigned int RtAudio :: getStreamReadAvailable( void ) { return rtapi_->getStreamReadAvailable(); }
+inline unsigned int RtAudio :: getStreamWriteAvailable( void ) { return rtapi_->getStreamWriteAvailable(); }
 inline bool RtAudio :: isStreamOpen( void ) const { return rtapi_->isStreamOpen(); }
 inline bool RtAudio :: isStreamRunning( void ) const { return rtapi_->isStreamRunning(); }
 inline long RtAudio :: getStreamLatency( void ) { return rtapi_->getStreamLatency(); }
+inline long RtAudio :: getStreamAddedLatency( void ) { return rtapi_->getStreamAddedLatency(); }
+inline long RtAudio :: getStreamInputLatency( void ) { return rtapi_->getStreamInputLatency(); }
+inline long RtAudio :: getStreamOutputLatency( void ) { return rtapi_->getStreamOutputLatency(); }
+inline RtAudio::StreamStats RtAudio :: getStreamStats( void ) { return rtapi_->getStreamStats(); }
 inline unsigned int RtAudio :: getStreamSampleRate( void ) { return rtapi_->getStreamSampleRate(); }
+inline double RtAudio :: getStreamStartOffset( void ) { return rtapi_->getStreamStartOffset(); }
 inline double RtAudio :: getStreamTime( void ) { return rtapi_->getStreamTime(); }
 inline void RtAudio :: setStreamTime( double time ) { return rtapi_->setStreamTime( time ); }
 inline void RtAudio :: showWarnings( bool value ) { rtapi_->showWarnings( value ); }
+inline void RtAudio :: setDeviceCacheFile( const std::string &path ) { rtapi_->setDeviceCacheFile( path ); }
 
 // RtApi Subclass prototypes.
 
@@ -906,6 +1867,8 @@ public:
   RtAudio::Api getCurrentApi( void ) { return RtAudio::UNIX_JACK; }
   unsigned int getDeviceCount( void );
   RtAudio::DeviceInfo getDeviceInfo( unsigned int device );
+  std::vector<RtAudio::DeviceInfo> getDevices( bool probeCapabilities );
+  bool setDeviceCallback( RtAudioDeviceCallback callback, void *userData );
   void closeStream( void );
   void startStream( void );
   void stopStream( void );
@@ -918,8 +1881,17 @@ public:
   // will most likely produce highly undesireable results!
   bool callbackEvent( unsigned long nframes );
 
+  // This function is intended for internal use only.  It is called
+  // by the Jack registration and shutdown callbacks.
+  void deviceEvent( void );
+
   private:
 
+  void *notifyClient_; // The client receiving registration callbacks.
+
+  void stopDeviceNotification( void );
+  void *openInfoClient( const char *name );
+  void closeInfoClient( void *client );
   bool probeDeviceOpen( unsigned int device, StreamMode mode, unsigned int channels, 
                         unsigned int firstChannel, unsigned int sampleRate,
                         RtAudioFormat format, unsigned int *bufferSize,
@@ -1053,10 +2025,16 @@ public:
   RtAudio::Api getCurrentApi() { return RtAudio::LINUX_ALSA; }
   unsigned int getDeviceCount( void );
   RtAudio::DeviceInfo getDeviceInfo( unsigned int device );
+  std::vector<RtAudio::DeviceInfo> getDevices( bool probeCapabilities );
+  bool findDevice( const std::string &identifier, unsigned int *device );
+  bool setDeviceCallback( RtAudioDeviceCallback callback, void *userData );
   void closeStream( void );
   void startStream( void );
   void stopStream( void );
   void abortStream( void );
+  void tickStream( void );
+  unsigned int getStreamPollDescriptors( struct pollfd *pfds, unsigned int space );
+  bool isStreamReady( void );
 
   // This function is intended for internal use only.  It must be
   // public because it is called by the internal callback handler,
@@ -1064,9 +2042,59 @@ public:
   // will most likely produce highly undesireable results!
   void callbackEvent( void );
 
+  // This function is intended for internal use only.  It runs the
+  // thread that waits for changes of the cards.
+  void deviceEvent( void );
+
   private:
 
-  std::vector<RtAudio::DeviceInfo> devices_;
+  bool reconfigureDevices( unsigned int sampleRate, unsigned int *bufferSize );
+  bool canReconfigure( void ) { return true; }
+  bool armStreamStart( void );
+  bool linkStream( RtApi *api );
+  void unlinkStream( void );
+  bool isStreamPrimed( void );
+  void triggerStreamStart( void );
+  void completeStreamStart( void );
+  // The devices found by the last enumeration, which is only
+  // repeated after a change in /dev/snd, and their probed information.
+  struct AlsaDevice {
+    int card;
+    int subdevice;  // -1 for the "default" device.
+    std::string identifier; // The PCM name, by card identifier.
+    std::string fingerprint; // Empty for the "default" device.
+  };
+  std::vector<AlsaDevice> deviceList_;
+  std::vector<RtAudio::DeviceInfo> deviceInfo_;
+  int inotifyFd_;
+  bool isEnumerated_;
+  // The separate watch of /dev/snd that feeds the device callback,
+  // and the pipe that stops its thread when the write end is closed.
+  int notifyFd_;
+  int notifyPipe_[2];
+  ThreadHandle notifyThread_;
+  bool isNotifying_;
+
+  void stopDeviceNotification( void );
+
+  // The capabilities read from and written to the device cache file,
+  // with the fingerprint of the device they were probed for.
+  struct CachedDevice {
+    std::string identifier;
+    std::string fingerprint;
+    RtAudio::DeviceInfo info;
+  };
+  std::vector<CachedDevice> deviceCache_;
+  std::string deviceCacheRead_; // The file deviceCache_ was read from.
+
+  bool getCachedDeviceInfo( unsigned int device );
+  void setCachedDeviceInfo( unsigned int device );
+  void readDeviceCache( void );
+  void writeDeviceCache( void );
+  void updateDeviceList( void );
+  void probeDevices( const std::vector<unsigned int> &devices, bool probeCapabilities );
+  void adaptBuffering( int change );
+  unsigned int getReadyPeriods( void );
   void saveDeviceInfo( void );
   bool probeDeviceOpen( unsigned int device, StreamMode mode, unsigned int channels, 
                         unsigned int firstChannel, unsigned int sampleRate,
@@ -1089,6 +2117,7 @@ public:
   void startStream( void );
   void stopStream( void );
   void abortStream( void );
+  void tickStream( void );
 
   // This function is intended for internal use only.  It must be
   // public because it is called by the internal callback handler,
@@ -1119,10 +2148,14 @@ public:
   RtAudio::Api getCurrentApi() { return RtAudio::LINUX_OSS; }
   unsigned int getDeviceCount( void );
   RtAudio::DeviceInfo getDeviceInfo( unsigned int device );
+  std::vector<RtAudio::DeviceInfo> getDevices( bool probeCapabilities );
   void closeStream( void );
   void startStream( void );
   void stopStream( void );
   void abortStream( void );
+  void tickStream( void );
+  unsigned int getStreamPollDescriptors( struct pollfd *pfds, unsigned int space );
+  bool isStreamReady( void );
 
   // This function is intended for internal use only.  It must be
   // public because it is called by the internal callback handler,
@@ -1132,6 +2165,10 @@ public:
 
   private:
 
+  bool reconfigureDevices( unsigned int sampleRate, unsigned int *bufferSize );
+  bool canReconfigure( void ) { return true; }
+  bool adaptBuffering( int change );
+  RtAudio::DeviceInfo probeDeviceInfo( int mixerfd, unsigned int device );
   bool probeDeviceOpen( unsigned int device, StreamMode mode, unsigned int channels, 
                         unsigned int firstChannel, unsigned int sampleRate,
                         RtAudioFormat format, unsigned int *bufferSize,
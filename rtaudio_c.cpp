@@ -50,6 +50,10 @@ const char *rtaudio_version() { return RTAUDIO_VERSION; }
 
 const rtaudio_api_t *rtaudio_compiled_api() { return compiled_api; }
 
+rtaudio_api_t rtaudio_compiled_api_by_name(const char *name) {
+  return (rtaudio_api_t)RtAudio::getCompiledApiByName(name ? name : "");
+}
+
 const char *rtaudio_error(rtaudio_t audio) {
   if (audio->has_error) {
     return audio->errmsg;
@@ -68,6 +72,17 @@ rtaudio_t rtaudio_create(rtaudio_api_t api) {
   return audio;
 }
 
+rtaudio_t rtaudio_create_stream_handle(rtaudio_t audio) {
+  rtaudio_t handle = new struct rtaudio();
+  try {
+    handle->audio = audio->audio->createStreamHandle();
+  } catch (RtAudioError &err) {
+    handle->has_error = 1;
+    strncpy(handle->errmsg, err.what(), sizeof(handle->errmsg) - 1);
+  }
+  return handle;
+}
+
 void rtaudio_destroy(rtaudio_t audio) { delete audio->audio; }
 
 rtaudio_api_t rtaudio_current_api(rtaudio_t audio) {
@@ -78,26 +93,36 @@ int rtaudio_device_count(rtaudio_t audio) {
   return audio->audio->getDeviceCount();
 }
 
+static rtaudio_device_info_t convert_device_info(const RtAudio::DeviceInfo &info) {
+  rtaudio_device_info_t result;
+  std::memset(&result, 0, sizeof(result));
+  result.probed = info.probed;
+  result.output_channels = info.outputChannels;
+  result.input_channels = info.inputChannels;
+  result.duplex_channels = info.duplexChannels;
+  result.is_default_output = info.isDefaultOutput;
+  result.is_default_input = info.isDefaultInput;
+  result.native_formats = info.nativeFormats;
+  result.preferred_sample_rate = info.preferredSampleRate;
+  result.min_sample_rate = info.minSampleRate;
+  result.max_sample_rate = info.maxSampleRate;
+  strncpy(result.name, info.name.c_str(), sizeof(result.name) - 1);
+  strncpy(result.identifier, info.identifier.c_str(),
+          sizeof(result.identifier) - 1);
+  for (unsigned int j = 0; j < info.sampleRates.size(); j++) {
+    if (j < sizeof(result.sample_rates) / sizeof(result.sample_rates[0])) {
+      result.sample_rates[j] = info.sampleRates[j];
+    }
+  }
+  return result;
+}
+
 rtaudio_device_info_t rtaudio_get_device_info(rtaudio_t audio, int i) {
   rtaudio_device_info_t result;
   std::memset(&result, 0, sizeof(result));
   try {
     audio->has_error = 0;
-    RtAudio::DeviceInfo info = audio->audio->getDeviceInfo(i);
-    result.probed = info.probed;
-    result.output_channels = info.outputChannels;
-    result.input_channels = info.inputChannels;
-    result.duplex_channels = info.duplexChannels;
-    result.is_default_output = info.isDefaultOutput;
-    result.is_default_input = info.isDefaultInput;
-    result.native_formats = info.nativeFormats;
-    result.preferred_sample_rate = info.preferredSampleRate;
-    strncpy(result.name, info.name.c_str(), sizeof(result.name) - 1);
-    for (unsigned int j = 0; j < info.sampleRates.size(); j++) {
-      if (j < sizeof(result.sample_rates) / sizeof(result.sample_rates[0])) {
-        result.sample_rates[j] = info.sampleRates[j];
-      }
-    }
+    result = convert_device_info(audio->audio->getDeviceInfo(i));
   } catch (RtAudioError &err) {
     audio->has_error = 1;
     strncpy(audio->errmsg, err.what(), sizeof(audio->errmsg) - 1);
@@ -105,6 +130,36 @@ rtaudio_device_info_t rtaudio_get_device_info(rtaudio_t audio, int i) {
   return result;
 }
 
+int rtaudio_get_devices(rtaudio_t audio, rtaudio_device_info_t *devices,
+                        unsigned int max_devices) {
+  try {
+    audio->has_error = 0;
+    std::vector<RtAudio::DeviceInfo> infos = audio->audio->getDevices();
+    for (unsigned int i = 0; i < infos.size() && i < max_devices; i++) {
+      devices[i] = convert_device_info(infos[i]);
+    }
+    return infos.size();
+  } catch (RtAudioError &err) {
+    audio->has_error = 1;
+    strncpy(audio->errmsg, err.what(), sizeof(audio->errmsg) - 1);
+  }
+  return -1;
+}
+
+int rtaudio_find_device(rtaudio_t audio, const char *identifier) {
+  try {
+    audio->has_error = 0;
+    unsigned int device;
+    if (audio->audio->findDevice(identifier ? identifier : "", &device)) {
+      return device;
+    }
+  } catch (RtAudioError &err) {
+    audio->has_error = 1;
+    strncpy(audio->errmsg, err.what(), sizeof(audio->errmsg) - 1);
+  }
+  return -1;
+}
+
 unsigned int rtaudio_get_default_output_device(rtaudio_t audio) {
   return audio->audio->getDefaultOutputDevice();
 }
@@ -113,6 +168,20 @@ unsigned int rtaudio_get_default_input_device(rtaudio_t audio) {
   return audio->audio->getDefaultInputDevice();
 }
 
+int rtaudio_set_device_callback(rtaudio_t audio, rtaudio_device_cb_t cb,
+                                void *userdata) {
+  try {
+    audio->has_error = 0;
+    if (audio->audio->setDeviceCallback(cb, userdata)) {
+      return 0;
+    }
+  } catch (RtAudioError &err) {
+    audio->has_error = 1;
+    strncpy(audio->errmsg, err.what(), sizeof(audio->errmsg) - 1);
+  }
+  return -1;
+}
+
 static int proxy_cb_func(void *out, void *in, unsigned int nframes, double time,
                          RtAudioStreamStatus status, void *userdata) {
   rtaudio_t audio = (rtaudio_t)userdata;
@@ -154,6 +223,7 @@ int rtaudio_open_stream(rtaudio_t audio,
       stream_opts.flags = (RtAudioStreamFlags)options->flags;
       stream_opts.numberOfBuffers = options->num_buffers;
       stream_opts.priority = options->priority;
+      stream_opts.targetLatency = options->target_latency;
       if (strlen(options->name) > 0) {
         stream_opts.streamName = std::string(options->name);
       }
@@ -162,7 +232,8 @@ int rtaudio_open_stream(rtaudio_t audio,
     audio->cb = cb;
     audio->userdata = userdata;
     audio->audio->openStream(out, in, (RtAudioFormat)format, sample_rate,
-                             buffer_frames, proxy_cb_func, (void *)audio, opts,
+                             buffer_frames, cb ? proxy_cb_func : NULL,
+                             (void *)audio, opts,
                              NULL);
     return 0;
   } catch (RtAudioError &err) {
@@ -207,6 +278,112 @@ int rtaudio_abort_stream(rtaudio_t audio) {
   return 0;
 }
 
+int rtaudio_tick_stream(rtaudio_t audio) {
+  try {
+    audio->has_error = 0;
+    audio->audio->tickStream();
+  } catch (RtAudioError &err) {
+    audio->has_error = 1;
+    strncpy(audio->errmsg, err.what(), sizeof(audio->errmsg) - 1);
+    return -1;
+  }
+  return 0;
+}
+
+int rtaudio_reconfigure_stream(rtaudio_t audio, unsigned int *buffer_frames,
+                               unsigned int sample_rate) {
+  try {
+    audio->has_error = 0;
+    audio->audio->reconfigureStream(buffer_frames, sample_rate);
+  } catch (RtAudioError &err) {
+    audio->has_error = 1;
+    strncpy(audio->errmsg, err.what(), sizeof(audio->errmsg) - 1);
+    return -1;
+  }
+  return 0;
+}
+
+int rtaudio_read_stream(rtaudio_t audio, void *buffer, unsigned int frames,
+                        int blocking) {
+  try {
+    audio->has_error = 0;
+    return audio->audio->readStream(buffer, frames, blocking != 0);
+  } catch (RtAudioError &err) {
+    audio->has_error = 1;
+    strncpy(audio->errmsg, err.what(), sizeof(audio->errmsg) - 1);
+    return -1;
+  }
+}
+
+int rtaudio_write_stream(rtaudio_t audio, const void *buffer,
+                         unsigned int frames, int blocking) {
+  try {
+    audio->has_error = 0;
+    return audio->audio->writeStream(buffer, frames, blocking != 0);
+  } catch (RtAudioError &err) {
+    audio->has_error = 1;
+    strncpy(audio->errmsg, err.what(), sizeof(audio->errmsg) - 1);
+    return -1;
+  }
+}
+
+int rtaudio_get_stream_read_available(rtaudio_t audio) {
+  try {
+    audio->has_error = 0;
+    return audio->audio->getStreamReadAvailable();
+  } catch (RtAudioError &err) {
+    audio->has_error = 1;
+    strncpy(audio->errmsg, err.what(), sizeof(audio->errmsg) - 1);
+    return -1;
+  }
+}
+
+int rtaudio_get_stream_write_available(rtaudio_t audio) {
+  try {
+    audio->has_error = 0;
+    return audio->audio->getStreamWriteAvailable();
+  } catch (RtAudioError &err) {
+    audio->has_error = 1;
+    strncpy(audio->errmsg, err.what(), sizeof(audio->errmsg) - 1);
+    return -1;
+  }
+}
+
+// Errors are reported through the first stream of the group.
+int rtaudio_start_stream_group(rtaudio_t *audios, unsigned int count) {
+  if (count == 0)
+    return 0;
+  std::vector<RtAudio *> streams;
+  for (unsigned int i = 0; i < count; i++)
+    streams.push_back(audios[i]->audio);
+  try {
+    audios[0]->has_error = 0;
+    RtAudio::startStreamGroup(streams);
+  } catch (RtAudioError &err) {
+    audios[0]->has_error = 1;
+    strncpy(audios[0]->errmsg, err.what(), sizeof(audios[0]->errmsg) - 1);
+    return -1;
+  }
+  return 0;
+}
+
+int rtaudio_stop_stream_group(rtaudio_t *audios, unsigned int count) {
+  if (count == 0)
+    return 0;
+  std::vector<RtAudio *> streams;
+  for (unsigned int i = 0; i < count; i++)
+    streams.push_back(audios[i]->audio);
+  try {
+    audios[0]->has_error = 0;
+    RtAudio::stopStreamGroup(streams);
+  } catch (RtAudioError &err) {
+    audios[0]->has_error = 1;
+    strncpy(audios[0]->errmsg, err.what(), sizeof(audios[0]->errmsg) - 1);
+    return -1;
+  }
+  return 0;
+}
+
 int rtaudio_is_stream_open(rtaudio_t audio) {
   return !!audio->audio->isStreamOpen();
 }
@@ -247,6 +424,59 @@ int rtaudio_get_stream_latency(rtaudio_t audio) {
   }
 }
 
+int rtaudio_get_stream_added_latency(rtaudio_t audio) {
+  try {
+    audio->has_error = 0;
+    return audio->audio->getStreamAddedLatency();
+  } catch (RtAudioError &err) {
+    audio->has_error = 1;
+    strncpy(audio->errmsg, err.what(), sizeof(audio->errmsg) - 1);
+    return -1;
+  }
+}
+
+int rtaudio_get_stream_input_latency(rtaudio_t audio) {
+  try {
+    audio->has_error = 0;
+    return audio->audio->getStreamInputLatency();
+  } catch (RtAudioError &err) {
+    audio->has_error = 1;
+    strncpy(audio->errmsg, err.what(), sizeof(audio->errmsg) - 1);
+    return -1;
+  }
+}
+
+int rtaudio_get_stream_output_latency(rtaudio_t audio) {
+  try {
+    audio->has_error = 0;
+    return audio->audio->getStreamOutputLatency();
+  } catch (RtAudioError &err) {
+    audio->has_error = 1;
+    strncpy(audio->errmsg, err.what(), sizeof(audio->errmsg) - 1);
+    return -1;
+  }
+}
+
+rtaudio_stream_stats_t rtaudio_get_stream_stats(rtaudio_t audio) {
+  rtaudio_stream_stats_t result;
+  std::memset(&result, 0, sizeof(result));
+  try {
+    audio->has_error = 0;
+    RtAudio::StreamStats stats = audio->audio->getStreamStats();
+    result.callbacks = stats.callbacks;
+    result.input_overflows = stats.inputOverflows;
+    result.output_underflows = stats.outputUnderflows;
+    result.buffer_increases = stats.bufferIncreases;
+    result.buffer_decreases = stats.bufferDecreases;
+    result.num_buffers = stats.nBuffers;
+    result.catch_ups = stats.catchUps;
+  } catch (RtAudioError &err) {
+    audio->has_error = 1;
+    strncpy(audio->errmsg, err.what(), sizeof(audio->errmsg) - 1);
+  }
+  return result;
+}
+
 unsigned int rtaudio_get_stream_sample_rate(rtaudio_t audio) {
   try {
     return audio->audio->getStreamSampleRate();
@@ -257,6 +487,20 @@ unsigned int rtaudio_get_stream_sample_rate(rtaudio_t audio) {
   }
 }
 
+double rtaudio_get_stream_start_offset(rtaudio_t audio) {
+  try {
+    return audio->audio->getStreamStartOffset();
+  } catch (RtAudioError &err) {
+    audio->has_error = 1;
+    strncpy(audio->errmsg, err.what(), sizeof(audio->errmsg) - 1);
+    return 0.0;
+  }
+}
+
 void rtaudio_show_warnings(rtaudio_t audio, int show) {
   audio->audio->showWarnings(!!show);
 }
+
+void rtaudio_set_device_cache_file(rtaudio_t audio, const char *path) {
+  audio->audio->setDeviceCacheFile(path ? path : "");
+}
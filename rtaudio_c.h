@@ -27,6 +27,13 @@ typedef unsigned int rtaudio_stream_flags_t;
 #define RTAUDIO_FLAGS_HOG_DEVICE 0x4
 #define RTAUDIO_FLAGS_SCHEDULE_REALTIME 0x8
 #define RTAUDIO_FLAGS_ALSA_USE_DEFAULT 0x10
+#define RTAUDIO_FLAGS_MANUAL_PUMP 0x40
+#define RTAUDIO_FLAGS_INDEPENDENT_DUPLEX 0x80
+#define RTAUDIO_FLAGS_FIXED_BLOCK_SIZE 0x100
+#define RTAUDIO_FLAGS_ADAPTIVE_BUFFERING 0x200
+#define RTAUDIO_FLAGS_WARM_STOP 0x400
+#define RTAUDIO_FLAGS_PREFILL_OUTPUT 0x800
+#define RTAUDIO_FLAGS_CATCH_UP 0x1000
 
 typedef unsigned int rtaudio_stream_status_t;
 
@@ -53,6 +60,8 @@ typedef enum rtaudio_error {
 
 typedef void (*rtaudio_error_cb_t)(rtaudio_error_t err, const char *msg);
 
+typedef void (*rtaudio_device_cb_t)(void *userdata);
+
 typedef enum rtaudio_api {
   RTAUDIO_API_UNSPECIFIED,
   RTAUDIO_API_LINUX_ALSA,
@@ -83,6 +92,11 @@ typedef struct rtaudio_device_info {
   int sample_rates[NUM_SAMPLE_RATES];
 
   char name[MAX_NAME_LENGTH];
+
+  unsigned int min_sample_rate;
+  unsigned int max_sample_rate;
+
+  char identifier[MAX_NAME_LENGTH];
 } rtaudio_device_info_t;
 
 typedef struct rtaudio_stream_parameters {
@@ -96,16 +110,29 @@ typedef struct rtaudio_stream_options {
   unsigned int num_buffers;
   int priority;
   char name[MAX_NAME_LENGTH];
+  unsigned int target_latency;
 } rtaudio_stream_options_t;
 
+typedef struct rtaudio_stream_stats {
+  unsigned long callbacks;
+  unsigned long input_overflows;
+  unsigned long output_underflows;
+  unsigned long buffer_increases;
+  unsigned long buffer_decreases;
+  unsigned int num_buffers;
+  unsigned long catch_ups;
+} rtaudio_stream_stats_t;
+
 typedef struct rtaudio *rtaudio_t;
 
 RTAUDIOAPI const char *rtaudio_version();
 RTAUDIOAPI const rtaudio_api_t *rtaudio_compiled_api();
+RTAUDIOAPI rtaudio_api_t rtaudio_compiled_api_by_name(const char *name);
 
 RTAUDIOAPI const char *rtaudio_error(rtaudio_t audio);
 
 RTAUDIOAPI rtaudio_t rtaudio_create(rtaudio_api_t api);
+RTAUDIOAPI rtaudio_t rtaudio_create_stream_handle(rtaudio_t audio);
 RTAUDIOAPI void rtaudio_destroy(rtaudio_t audio);
 
 RTAUDIOAPI rtaudio_api_t rtaudio_current_api(rtaudio_t audio);
@@ -113,8 +140,15 @@ RTAUDIOAPI rtaudio_api_t rtaudio_current_api(rtaudio_t audio);
 RTAUDIOAPI int rtaudio_device_count(rtaudio_t audio);
 RTAUDIOAPI rtaudio_device_info_t rtaudio_get_device_info(rtaudio_t audio,
                                                          int i);
+RTAUDIOAPI int rtaudio_get_devices(rtaudio_t audio,
+                                   rtaudio_device_info_t *devices,
+                                   unsigned int max_devices);
+RTAUDIOAPI int rtaudio_find_device(rtaudio_t audio, const char *identifier);
 RTAUDIOAPI unsigned int rtaudio_get_default_output_device(rtaudio_t audio);
 RTAUDIOAPI unsigned int rtaudio_get_default_input_device(rtaudio_t audio);
+RTAUDIOAPI int rtaudio_set_device_callback(rtaudio_t audio,
+                                           rtaudio_device_cb_t cb,
+                                           void *userdata);
 
 RTAUDIOAPI int
 rtaudio_open_stream(rtaudio_t audio, rtaudio_stream_parameters_t *output_params,
@@ -127,6 +161,18 @@ RTAUDIOAPI void rtaudio_close_stream(rtaudio_t audio);
 RTAUDIOAPI int rtaudio_start_stream(rtaudio_t audio);
 RTAUDIOAPI int rtaudio_stop_stream(rtaudio_t audio);
 RTAUDIOAPI int rtaudio_abort_stream(rtaudio_t audio);
+RTAUDIOAPI int rtaudio_tick_stream(rtaudio_t audio);
+RTAUDIOAPI int rtaudio_reconfigure_stream(rtaudio_t audio,
+                                          unsigned int *buffer_frames,
+                                          unsigned int sample_rate);
+RTAUDIOAPI int rtaudio_read_stream(rtaudio_t audio, void *buffer,
+                                   unsigned int frames, int blocking);
+RTAUDIOAPI int rtaudio_write_stream(rtaudio_t audio, const void *buffer,
+                                    unsigned int frames, int blocking);
+RTAUDIOAPI int rtaudio_get_stream_read_available(rtaudio_t audio);
+RTAUDIOAPI int rtaudio_get_stream_write_available(rtaudio_t audio);
+RTAUDIOAPI int rtaudio_start_stream_group(rtaudio_t *audios, unsigned int count);
+RTAUDIOAPI int rtaudio_stop_stream_group(rtaudio_t *audios, unsigned int count);
 
 RTAUDIOAPI int rtaudio_is_stream_open(rtaudio_t audio);
 RTAUDIOAPI int rtaudio_is_stream_running(rtaudio_t audio);
@@ -134,9 +180,16 @@ RTAUDIOAPI int rtaudio_is_stream_running(rtaudio_t audio);
 RTAUDIOAPI double rtaudio_get_stream_time(rtaudio_t audio);
 RTAUDIOAPI void rtaudio_set_stream_time(rtaudio_t audio, double time);
 RTAUDIOAPI int rtaudio_get_stream_latency(rtaudio_t audio);
+RTAUDIOAPI int rtaudio_get_stream_added_latency(rtaudio_t audio);
+RTAUDIOAPI int rtaudio_get_stream_input_latency(rtaudio_t audio);
+RTAUDIOAPI int rtaudio_get_stream_output_latency(rtaudio_t audio);
+RTAUDIOAPI rtaudio_stream_stats_t rtaudio_get_stream_stats(rtaudio_t audio);
 RTAUDIOAPI unsigned int rtaudio_get_stream_sample_rate(rtaudio_t audio);
+RTAUDIOAPI double rtaudio_get_stream_start_offset(rtaudio_t audio);
 
 RTAUDIOAPI void rtaudio_show_warnings(rtaudio_t audio, int show);
+RTAUDIOAPI void rtaudio_set_device_cache_file(rtaudio_t audio,
+                                              const char *path);
 
 #ifdef __cplusplus
 }
@@ -39,13 +39,15 @@ int main()
 
   std::cout << "\nCurrent API: " << apiMap[ audio.getCurrentApi() ] << std::endl;
 
-  unsigned int devices = audio.getDeviceCount();
-  std::cout << "\nFound " << devices << " device(s) ...\n";
+  std::vector<RtAudio::DeviceInfo> devices = audio.getDevices();
+  std::cout << "\nFound " << devices.size() << " device(s) ...\n";
 
-  for (unsigned int i=0; i<devices; i++) {
-    info = audio.getDeviceInfo(i);
+  for (unsigned int i=0; i<devices.size(); i++) {
+    info = devices[i];
 
     std::cout << "\nDevice Name = " << info.name << '\n';
+    if ( !info.identifier.empty() )
+      std::cout << "Identifier = " << info.identifier << '\n';
     if ( info.probed == false )
       std::cout << "Probe Status = UNsuccessful\n";
     else {
@@ -82,6 +84,8 @@ int main()
           std::cout << info.sampleRates[j] << " ";
       }
       std::cout << std::endl;
+      if ( info.maxSampleRate > 0 )
+        std::cout << "Sample rate range = " << info.minSampleRate << " - " << info.maxSampleRate << std::endl;
     }
   }
   std::cout << std::endl;
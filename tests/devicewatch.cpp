@@ -0,0 +1,68 @@
+/******************************************/
+/*
+  devicewatch.cpp
+
+  This program lists the audio devices
+  again each time they change, as reported
+  by the device callback, without polling.
+*/
+/******************************************/
+
+#include "RtAudio.h"
+#include <iostream>
+#include <cstdlib>
+
+// Platform-dependent sleep routines.
+#if defined( __WINDOWS_ASIO__ ) || defined( __WINDOWS_DS__ ) || defined( __WINDOWS_WASAPI__ )
+  #include <windows.h>
+  #define SLEEP( milliseconds ) Sleep( (DWORD) milliseconds )
+#else // Unix variants
+  #include <unistd.h>
+  #define SLEEP( milliseconds ) usleep( (unsigned long) (milliseconds * 1000.0) )
+#endif
+
+// The callback only records the change, and the devices are listed
+// by the main thread.
+volatile bool changed = true;
+
+void deviceChange( void * /*userData*/ )
+{
+  changed = true;
+}
+
+void listDevices( RtAudio &audio )
+{
+  std::vector<RtAudio::DeviceInfo> devices = audio.getDevices( false );
+  std::cout << "\nFound " << devices.size() << " device(s):\n";
+  for ( unsigned int i=0; i<devices.size(); i++ ) {
+    std::cout << "  " << i << ": " << devices[i].name;
+    if ( !devices[i].identifier.empty() )
+      std::cout << " (" << devices[i].identifier << ")";
+    std::cout << '\n';
+  }
+}
+
+int main( int argc, char * /*argv*/[] )
+{
+  if ( argc > 1 ) {
+    std::cout << "\nuseage: devicewatch\n";
+    std::cout << "    lists the audio devices whenever they change, until interrupted.\n\n";
+    exit( 0 );
+  }
+
+  RtAudio audio;
+  if ( !audio.setDeviceCallback( &deviceChange ) ) {
+    std::cout << "\nDevice change notifications are not supported by this API!\n\n";
+    exit( 1 );
+  }
+
+  while ( 1 ) {
+    if ( changed ) {
+      changed = false;
+      listDevices( audio );
+    }
+    SLEEP( 100 );
+  }
+
+  return 0;
+}
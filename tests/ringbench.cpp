@@ -0,0 +1,202 @@
+/******************************************/
+/*
+  ringbench.cpp
+
+  This program measures the throughput and
+  latency of the RtAudioRingBuffer class
+  between two or more threads.
+*/
+/******************************************/
+
+#include "RtAudio.h"
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+
+// Platform-dependent thread and timing routines.
+#if defined( __WINDOWS_ASIO__ ) || defined( __WINDOWS_DS__ ) || defined( __WINDOWS_WASAPI__ )
+  #include <windows.h>
+  #include <process.h>
+  typedef HANDLE BenchThread;
+  #define THREAD_FUNCTION( name ) unsigned __stdcall name( void *ptr )
+  #define YIELD() SwitchToThread()
+
+  static void startThread( BenchThread *thread, unsigned (__stdcall *function)( void * ), void *data )
+  { *thread = (HANDLE) _beginthreadex( NULL, 0, function, data, 0, NULL ); }
+  static void joinThread( BenchThread thread )
+  { WaitForSingleObject( thread, INFINITE ); CloseHandle( thread ); }
+  static double now( void )
+  {
+    LARGE_INTEGER count, frequency;
+    QueryPerformanceCounter( &count );
+    QueryPerformanceFrequency( &frequency );
+    return (double) count.QuadPart / frequency.QuadPart;
+  }
+#else // Unix variants
+  #include <pthread.h>
+  #include <sched.h>
+  #include <sys/time.h>
+  typedef pthread_t BenchThread;
+  #define THREAD_FUNCTION( name ) void *name( void *ptr )
+  #define YIELD() sched_yield()
+
+  static void startThread( BenchThread *thread, void *(*function)( void * ), void *data )
+  { pthread_create( thread, NULL, function, data ); }
+  static void joinThread( BenchThread thread )
+  { pthread_join( thread, NULL ); }
+  static double now( void )
+  {
+    struct timeval time;
+    gettimeofday( &time, NULL );
+    return time.tv_sec + time.tv_usec * 1e-6;
+  }
+#endif
+
+typedef RtAudioRingBuffer<float> RingBuffer;
+
+void usage( void ) {
+  // Error function in case of incorrect command-line
+  // argument specifications
+  std::cout << "\nuseage: ringbench <frames> <channels> <block> <capacity> <pings>\n";
+  std::cout << "    where frames = the number of frames to transfer (default = 10000000),\n";
+  std::cout << "    channels = the number of channels (default = 2),\n";
+  std::cout << "    block = the number of frames per write and read (default = 256),\n";
+  std::cout << "    capacity = the ring buffer size in frames (default = 4096),\n";
+  std::cout << "    and pings = the number of latency round trips (default = 10000).\n\n";
+  exit( 0 );
+}
+
+struct Producer {
+  RingBuffer *ring;
+  unsigned long frames;
+  unsigned int block;
+};
+
+// Writes blocks of frames, rendered directly into the ring buffer.
+THREAD_FUNCTION( produce )
+{
+  Producer *producer = (Producer *) ptr;
+  RingBuffer::Region region;
+  unsigned int channels = producer->ring->getChannels();
+  unsigned long written = 0;
+  while ( written < producer->frames ) {
+    unsigned int block = producer->block;
+    if ( block > producer->frames - written ) block = producer->frames - written;
+    unsigned int n = producer->ring->reserveWrite( block, &region );
+    for ( int i=0; i<2; i++ )
+      for ( unsigned int j=0; j<region.frames[i] * channels; j++ )
+        region.data[i][j] = (float) j;
+    producer->ring->commitWrite( region );
+    if ( n == 0 ) YIELD();
+    written += n;
+  }
+  return 0;
+}
+
+// Measures the time to transfer the given frames from one or more
+// producer threads to the calling thread.
+void measureThroughput( RingBuffer &ring, unsigned int nProducers, unsigned long frames, unsigned int block )
+{
+  std::vector<Producer> producers( nProducers );
+  std::vector<BenchThread> threads( nProducers );
+  std::vector<float> buffer( block * ring.getChannels() );
+  ring.reset();
+
+  double start = now();
+  for ( unsigned int i=0; i<nProducers; i++ ) {
+    producers[i].ring = &ring;
+    producers[i].frames = frames / nProducers;
+    producers[i].block = block;
+    startThread( &threads[i], produce, &producers[i] );
+  }
+
+  unsigned long total = ( frames / nProducers ) * nProducers, read = 0;
+  while ( read < total ) {
+    unsigned int n = ring.read( &buffer[0], block );
+    if ( n == 0 ) YIELD();
+    read += n;
+  }
+  double elapsed = now() - start;
+  for ( unsigned int i=0; i<nProducers; i++ ) joinThread( threads[i] );
+
+  std::cout << "  " << nProducers << " producer(s): " << total / elapsed / 1e6 << " Mframes/s ("
+            << total * ring.getChannels() * sizeof( float ) / elapsed / 1e6 << " MB/s)\n";
+}
+
+struct Echo {
+  RingBuffer *request;
+  RingBuffer *reply;
+  unsigned int pings;
+};
+
+// Returns each frame received on one ring buffer on the other one.
+THREAD_FUNCTION( echo )
+{
+  Echo *data = (Echo *) ptr;
+  std::vector<float> frame( data->request->getChannels() );
+  for ( unsigned int i=0; i<data->pings; i++ ) {
+    while ( data->request->read( &frame[0], 1 ) == 0 ) YIELD();
+    while ( data->reply->write( &frame[0], 1 ) == 0 ) YIELD();
+  }
+  return 0;
+}
+
+// Measures the round-trip time of single frames between two threads.
+void measureLatency( unsigned int channels, unsigned int capacity, unsigned int pings )
+{
+  RingBuffer request( capacity, channels ), reply( capacity, channels );
+  std::vector<float> frame( channels, 0.0f );
+  Echo data;
+  data.request = &request;
+  data.reply = &reply;
+  data.pings = pings;
+
+  BenchThread thread;
+  startThread( &thread, echo, &data );
+
+  double sum = 0.0, maximum = 0.0;
+  for ( unsigned int i=0; i<pings; i++ ) {
+    double start = now();
+    request.write( &frame[0], 1 );
+    while ( reply.read( &frame[0], 1 ) == 0 ) YIELD();
+    double elapsed = now() - start;
+    sum += elapsed;
+    if ( elapsed > maximum ) maximum = elapsed;
+  }
+  joinThread( thread );
+
+  std::cout << "  round trip: " << sum / pings * 1e6 << " us average, "
+            << maximum * 1e6 << " us maximum\n";
+}
+
+int main( int argc, char *argv[] )
+{
+  unsigned long frames = 10000000;
+  unsigned int channels = 2, block = 256, capacity = 4096, pings = 10000;
+
+  if ( argc > 1 && ( argv[1][0] < '0' || argv[1][0] > '9' ) ) usage();
+  if ( argc > 1 ) frames = (unsigned long) atol( argv[1] );
+  if ( argc > 2 ) channels = (unsigned int) atoi( argv[2] );
+  if ( argc > 3 ) block = (unsigned int) atoi( argv[3] );
+  if ( argc > 4 ) capacity = (unsigned int) atoi( argv[4] );
+  if ( argc > 5 ) pings = (unsigned int) atoi( argv[5] );
+  if ( frames == 0 || channels == 0 || block == 0 || capacity == 0 || pings == 0 ) usage();
+
+  RingBuffer ring( capacity, channels );
+  std::cout << "\nRtAudioRingBuffer: " << ring.getCapacity() << " frames of " << channels
+            << " channels, " << block << " frames per block.\n";
+
+  std::cout << "\nThroughput (single producer):\n";
+  measureThroughput( ring, 1, frames, block );
+
+  std::cout << "\nThroughput (multiple producers):\n";
+  ring.setMode( RingBuffer::MULTI_PRODUCER );
+  measureThroughput( ring, 2, frames, block );
+  measureThroughput( ring, 4, frames, block );
+
+  std::cout << "\nLatency:\n";
+  measureLatency( channels, capacity, pings );
+  std::cout << std::endl;
+
+  return 0;
+}
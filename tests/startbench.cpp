@@ -0,0 +1,154 @@
+/******************************************/
+/*
+  startbench.cpp
+
+  This program measures the time between
+  RtAudio::startStream() and the first
+  callback of an output stream, with and
+  without the RTAUDIO_WARM_STOP flag.
+*/
+/******************************************/
+
+#include "RtAudio.h"
+#include <iostream>
+#include <cstdlib>
+
+#define REPETITIONS 50
+#define RUNTIME     0.05  // seconds
+#define PAUSETIME   0.05  // seconds
+
+// Platform-dependent sleep and timing routines.
+#if defined( __WINDOWS_ASIO__ ) || defined( __WINDOWS_DS__ ) || defined( __WINDOWS_WASAPI__ )
+  #include <windows.h>
+  #define SLEEP( milliseconds ) Sleep( (DWORD) milliseconds )
+  static double now( void )
+  {
+    LARGE_INTEGER count, frequency;
+    QueryPerformanceCounter( &count );
+    QueryPerformanceFrequency( &frequency );
+    return (double) count.QuadPart / frequency.QuadPart;
+  }
+#else // Unix variants
+  #include <unistd.h>
+  #include <sys/time.h>
+  #define SLEEP( milliseconds ) usleep( (unsigned long) (milliseconds * 1000.0) )
+  static double now( void )
+  {
+    struct timeval time;
+    gettimeofday( &time, NULL );
+    return time.tv_sec + time.tv_usec * 1e-6;
+  }
+#endif
+
+void usage( void ) {
+  // Error function in case of incorrect command-line
+  // argument specifications
+  std::cout << "\nuseage: startbench N fs <device> <bufferFrames> <repetitions>\n";
+  std::cout << "    where N = number of channels,\n";
+  std::cout << "    fs = the sample rate,\n";
+  std::cout << "    device = optional device to use (default = 0),\n";
+  std::cout << "    bufferFrames = optional buffer size (default = 256),\n";
+  std::cout << "    and repetitions = optional number of starts (default = " << REPETITIONS << ").\n\n";
+  exit( 0 );
+}
+
+struct StartData {
+  unsigned int channels;
+  volatile double firstCallback;
+};
+
+// Records the time of the first callback after a start, and writes
+// silence.
+int silence( void *outputBuffer, void * /*inputBuffer*/, unsigned int nBufferFrames,
+             double /*streamTime*/, RtAudioStreamStatus /*status*/, void *data )
+{
+  StartData *start = (StartData *) data;
+  if ( start->firstCallback == 0.0 ) start->firstCallback = now();
+
+  float *buffer = (float *) outputBuffer;
+  for ( unsigned int i=0; i<nBufferFrames * start->channels; i++ )
+    *buffer++ = 0.0f;
+  return 0;
+}
+
+void measureStarts( RtAudio &dac, RtAudio::StreamParameters &oParams, unsigned int fs,
+                    unsigned int bufferFrames, unsigned int repetitions, RtAudioStreamFlags flags )
+{
+  StartData data;
+  data.channels = oParams.nChannels;
+  data.firstCallback = 0.0;
+
+  RtAudio::StreamOptions options;
+  options.flags = flags;
+  try {
+    dac.openStream( &oParams, NULL, RTAUDIO_FLOAT32, fs, &bufferFrames, &silence, (void *) &data, &options );
+  }
+  catch ( RtAudioError& e ) {
+    e.printMessage();
+    return;
+  }
+
+  double sum = 0.0, maximum = 0.0;
+  unsigned int count = 0;
+  try {
+    for ( unsigned int i=0; i<repetitions; i++ ) {
+      data.firstCallback = 0.0;
+      double start = now();
+      dac.startStream();
+      while ( data.firstCallback == 0.0 && now() - start < 1.0 ) SLEEP( 0.01 );
+      if ( data.firstCallback > 0.0 ) {
+        double elapsed = data.firstCallback - start;
+        sum += elapsed;
+        if ( elapsed > maximum ) maximum = elapsed;
+        count++;
+      }
+      SLEEP( RUNTIME * 1000.0 );
+      dac.stopStream();
+      SLEEP( PAUSETIME * 1000.0 );
+    }
+  }
+  catch ( RtAudioError& e ) {
+    e.printMessage();
+  }
+
+  if ( dac.isStreamOpen() ) dac.closeStream();
+
+  std::cout << ( flags & RTAUDIO_WARM_STOP ? "  warm stop: " : "  cold stop: " );
+  if ( count == 0 )
+    std::cout << "no callback received\n";
+  else
+    std::cout << sum / count * 1e3 << " ms average, " << maximum * 1e3 << " ms maximum ("
+              << bufferFrames * 1e3 / fs << " ms per buffer)\n";
+}
+
+int main( int argc, char *argv[] )
+{
+  unsigned int channels, fs, device = 0, bufferFrames = 256, repetitions = REPETITIONS;
+
+  // minimal command-line checking
+  if ( argc < 3 || argc > 6 ) usage();
+
+  RtAudio dac;
+  if ( dac.getDeviceCount() < 1 ) {
+    std::cout << "\nNo audio devices found!\n";
+    exit( 1 );
+  }
+
+  channels = (unsigned int) atoi( argv[1] );
+  fs = (unsigned int) atoi( argv[2] );
+  if ( argc > 3 ) device = (unsigned int) atoi( argv[3] );
+  if ( argc > 4 ) bufferFrames = (unsigned int) atoi( argv[4] );
+  if ( argc > 5 ) repetitions = (unsigned int) atoi( argv[5] );
+
+  RtAudio::StreamParameters oParams;
+  oParams.deviceId = device;
+  oParams.nChannels = channels;
+  if ( device == 0 ) oParams.deviceId = dac.getDefaultOutputDevice();
+
+  std::cout << "\nStart to first callback time, " << repetitions << " starts:\n";
+  measureStarts( dac, oParams, fs, bufferFrames, repetitions, 0 );
+  measureStarts( dac, oParams, fs, bufferFrames, repetitions, RTAUDIO_WARM_STOP );
+  std::cout << std::endl;
+
+  return 0;
+}